@@ -0,0 +1,142 @@
+// 定时器基准：原来的二叉堆调度（std::priority_queue + id 表惰性取消）与分层时间轮对比。
+// 两者都按 1ms tick 逐个推进、在调用线程上同步执行到期任务，只比较数据结构本身：
+// 注册 N 个随机延迟的单次任务，取消其中一半，再推进到全部到期。
+#include "timer_wheel_probe.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Task = TimerScheduler::Task;
+using BenchClock = std::chrono::steady_clock;
+
+constexpr uint64_t kMaxDelay = 60000;   // 一分钟内的延迟，覆盖时间轮的第 0～2 级
+
+// 原 TimerScheduler 的堆实现：任务在堆与 id 表中各存一份，取消只从表中删除，出堆时再丢弃
+class HeapTimers {
+public:
+    size_t add(uint64_t delay, Task task) {
+        size_t id = nextId_++;
+        TimerTask t{now_ + delay, std::move(task), id};
+        tasks_.emplace(id, t);
+        heap_.push(std::move(t));
+        return id;
+    }
+
+    bool cancel(size_t id) { return tasks_.erase(id) > 0; }
+
+    size_t advanceTo(uint64_t target) {
+        size_t n = 0;
+        now_ = target;
+        while (!heap_.empty() && heap_.top().nextRun <= now_) {
+            TimerTask t = heap_.top();
+            heap_.pop();
+            auto it = tasks_.find(t.id);
+            if (it == tasks_.end()) continue;   // 已取消
+            tasks_.erase(it);
+            t.task();
+            ++n;
+        }
+        return n;
+    }
+
+    uint64_t now() const { return now_; }
+
+private:
+    struct TimerTask {
+        uint64_t nextRun;
+        Task     task;
+        size_t   id;
+        bool operator<(const TimerTask& o) const { return nextRun > o.nextRun; }
+    };
+
+    std::priority_queue<TimerTask>        heap_;
+    std::unordered_map<size_t, TimerTask> tasks_;
+    size_t                                nextId_ = 0;
+    uint64_t                              now_ = 0;
+};
+
+struct Result {
+    double add_ms = 0, cancel_ms = 0, run_ms = 0;
+    size_t fired = 0;
+};
+
+double msSince(BenchClock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - t0).count();
+}
+
+/* 任务捕获一个 shared_ptr 和计数器指针，与采集任务一样超出 std::function 的内联存储 */
+template <typename Timers>
+Result run(Timers& timers, const std::vector<uint64_t>& delays) {
+    Result r;
+    auto payload = std::make_shared<int>(0);
+    size_t fired = 0;
+    std::vector<size_t> ids;
+    ids.reserve(delays.size());
+
+    auto t0 = BenchClock::now();
+    for (uint64_t d : delays) ids.push_back(timers.add(d, [payload, &fired] { ++fired; }));
+    r.add_ms = msSince(t0);
+
+    t0 = BenchClock::now();
+    for (size_t i = 0; i < ids.size(); i += 2) timers.cancel(ids[i]);
+    r.cancel_ms = msSince(t0);
+
+    t0 = BenchClock::now();
+    while (timers.now() < kMaxDelay) timers.advanceTo(timers.now() + 1);
+    r.run_ms = msSince(t0);
+
+    r.fired = fired;
+    return r;
+}
+
+// 让时间轮与堆实现同样的接口
+struct WheelTimers {
+    TimerScheduler  sched;
+    TimerWheelProbe probe{sched, 0};
+
+    explicit WheelTimers(WorkStealingExecutor& ex) : sched(ex) {}
+    size_t add(uint64_t delay, Task task) { return probe.arm(delay, std::move(task)); }
+    bool cancel(size_t id) { return sched.cancelTimer(id); }
+    size_t advanceTo(uint64_t target) { return probe.advanceTo(target); }
+    uint64_t now() const { return probe.now(); }
+};
+
+void print(const char* name, size_t n, const Result& r) {
+    std::printf("%-6s %8zu %10.2f %10.2f %10.2f %10.2f %8zu\n", name, n, r.add_ms, r.cancel_ms, r.run_ms,
+                r.add_ms + r.cancel_ms + r.run_ms, r.fired);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes{10000, 100000};
+    if (argc > 1) {
+        sizes.clear();
+        for (int i = 1; i < argc; ++i) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+
+    WorkStealingExecutor executor(1);
+    std::printf("%-6s %8s %10s %10s %10s %10s %8s\n", "impl", "timers", "add(ms)", "cancel(ms)", "run(ms)",
+                "total(ms)", "fired");
+    for (size_t n : sizes) {
+        std::mt19937_64 rng(n);
+        std::uniform_int_distribution<uint64_t> delay(1, kMaxDelay);
+        std::vector<uint64_t> delays(n);
+        for (auto& d : delays) d = delay(rng);
+
+        HeapTimers heap;
+        print("heap", n, run(heap, delays));
+        WheelTimers wheel(executor);
+        print("wheel", n, run(wheel, delays));
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+/* joblens_ctl.h
+ * JobLens 作业控制 Unix 域 socket（SOCK_SEQPACKET）的二进制协议与 C 客户端。
+ *
+ * 一个请求包由一条或多条记录首尾相接组成，每条记录为 jl_rec_hdr 加载荷：
+ *   int32_t pids[n_pids];                 JL_F_PIDS 时有效
+ *   char    lens[lens_bytes];             JL_F_LENS 时有效，采集器名以 '\0' 结尾依次排列
+ * 服务端对每个请求包回一个应答包：jl_ack_hdr 后跟 count 条 jl_ack，顺序与记录一致。
+ * 字段均为主机字节序（仅本机通信）。
+ */
+#ifndef JOBLENS_CTL_H
+#define JOBLENS_CTL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JL_MAGIC       0x314c434au   /* "JCL1" */
+#define JL_VERSION     1
+#define JL_MAX_PACKET  65536         /* 服务端接收缓冲大小，单个请求包不得超过 */
+
+enum jl_op {
+    JL_OP_ADD    = 1,   /* 需要 JL_F_PIDS 与 JL_F_LENS */
+    JL_OP_REMOVE = 2,
+    JL_OP_UPDATE = 3,   /* 替换给出的字段 */
+    JL_OP_ATTACH = 4,   /* 并入给出的 PID / 采集器 */
+    JL_OP_DETACH = 5    /* 移出给出的 PID / 采集器 */
+};
+
+enum jl_flag {
+    JL_F_PIDS  = 1u << 0,
+    JL_F_LENS  = 1u << 1,
+    JL_F_FREQ  = 1u << 2,   /* ADD / UPDATE */
+    JL_F_CTIME = 1u << 3    /* ADD */
+};
+
+enum jl_status {
+    JL_OK       = 0,
+    JL_E_PROTO  = 1,   /* 记录头或长度损坏，同一包内其后的记录不再处理 */
+    JL_E_INVAL  = 2,   /* 字段缺失或取值非法 */
+    JL_E_EXISTS = 3,   /* ADD 的作业已存在 */
+    JL_E_NOENT  = 4    /* 作业不存在 */
+};
+
+struct jl_rec_hdr {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t op;           /* enum jl_op */
+    uint32_t len;          /* 本条记录总字节数，含头部与载荷 */
+    uint32_t seq;          /* 由客户端指定，原样带回应答 */
+    int32_t  job_id;       /* 必须 > 0；0 保留给 JobLens 自身的守护进程级记录（lens_stats） */
+    uint32_t flags;        /* enum jl_flag */
+    uint32_t n_pids;
+    uint32_t lens_bytes;
+    double   freq;         /* 采样频率（Hz） */
+    int64_t  create_time;  /* 作业创建时间，Unix 秒 */
+};
+
+struct jl_ack_hdr {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+};
+
+struct jl_ack {
+    uint32_t seq;
+    int32_t  job_id;
+    int32_t  status;       /* enum jl_status */
+    uint32_t reserved;
+};
+
+#ifdef __cplusplus
+static_assert(sizeof(struct jl_rec_hdr) == 48, "jl_rec_hdr layout");
+static_assert(sizeof(struct jl_ack) == 16, "jl_ack layout");
+#else
+_Static_assert(sizeof(struct jl_rec_hdr) == 48, "jl_rec_hdr layout");
+_Static_assert(sizeof(struct jl_ack) == 16, "jl_ack layout");
+#endif
+
+/* ---------------- 客户端 ---------------- */
+
+/* 一条作业操作；未置位的 flags 对应字段被忽略 */
+struct jl_job_op {
+    uint16_t            op;
+    uint32_t            flags;
+    int32_t             job_id;
+    const int32_t*      pids;
+    uint32_t            n_pids;
+    const char* const*  lens;
+    uint32_t            n_lens;
+    double              freq;
+    int64_t             create_time;
+};
+
+typedef struct jl_client jl_client;
+
+/* 连接服务端；timeout_ms > 0 时作为等待应答的超时，超时后连接被断开（之后的调用返回 -ENOTCONN，需重新连接）。
+ * 失败返回 NULL 并设置 errno */
+jl_client* jl_connect(const char* path, int timeout_ms);
+void       jl_close(jl_client* c);
+
+/* 把 n 条操作编码进一个请求包同步提交，status[i] 收到第 i 条的 enum jl_status。
+ * 成功返回 0；失败返回 -errno（包过大为 -EMSGSIZE，应答不符为 -EPROTO，等待应答超时为 -ETIMEDOUT），
+ * 此时 status 无意义 */
+int jl_submit(jl_client* c, const struct jl_job_op* ops, size_t n, int32_t* status);
+
+/* 单条操作的便捷封装：返回 enum jl_status，或传输失败时的 -errno */
+int jl_add_job(jl_client* c, int32_t job_id, const int32_t* pids, uint32_t n_pids,
+               const char* const* lens, uint32_t n_lens, double freq);
+int jl_remove_job(jl_client* c, int32_t job_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JOBLENS_CTL_H */
@@ -0,0 +1,153 @@
+#pragma once
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LOGGER_TRACE
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <any>
+#include "collector/collector_type.h"
+#include "collector/rate_engine.hpp"
+#include "icollector.h"
+
+// 按作业读取 cgroup v2 统计：每个作业每周期只读 cpu.stat / memory.current / memory.stat /
+// io.stat / memory.events 五个文件，开销与作业内进程数无关。
+// 作业的 cgroup 取其所有 PID 所在 cgroup 的最近公共祖先（HTCondor 下即作业自己的 cgroup）；
+// 该祖先不是任何作业 PID 所在的 cgroup 时默认跳过，除非配置 allow_ancestor。
+namespace cgroup_collector {
+
+struct cgroup_info {
+    int8_t        type{int8_t(CollectorType::CgroupCollector)};
+    int           jobId{};
+    std::string   path;                 // 相对 cgroup 根的路径
+    std::uint64_t ino{};                // cgroup 目录 inode，迁移或重建后变化
+
+    // cpu.stat（微秒）
+    std::uint64_t cpuUsageUs{};
+    std::uint64_t cpuUserUs{};
+    std::uint64_t cpuSystemUs{};
+    std::uint64_t nrPeriods{};
+    std::uint64_t nrThrottled{};
+    std::uint64_t throttledUs{};
+
+    // memory.current / memory.stat（字节）
+    std::uint64_t memCurrent{};
+    std::uint64_t memAnon{};
+    std::uint64_t memFile{};
+    std::uint64_t memKernel{};
+    std::uint64_t memShmem{};
+    std::uint64_t memSock{};
+    std::uint64_t pgfault{};
+    std::uint64_t pgmajfault{};
+
+    // io.stat，所有设备之和
+    std::uint64_t ioReadBytes{};
+    std::uint64_t ioWriteBytes{};
+    std::uint64_t ioReadOps{};
+    std::uint64_t ioWriteOps{};
+
+    // memory.events
+    std::uint64_t memEventsLow{};
+    std::uint64_t memEventsHigh{};
+    std::uint64_t memEventsMax{};
+    std::uint64_t memEventsOom{};
+    std::uint64_t memEventsOomKill{};
+};
+
+namespace cols {
+inline constexpr Col<std::int64_t>     kJobId{0, "jobId"};
+inline constexpr Col<std::string_view> kPath{1, "path"};
+inline constexpr Col<std::uint64_t>    kCpuUsageUs{2, "cpuUsageUs"};
+inline constexpr Col<std::uint64_t>    kCpuUserUs{3, "cpuUserUs"};
+inline constexpr Col<std::uint64_t>    kCpuSystemUs{4, "cpuSystemUs"};
+inline constexpr Col<std::uint64_t>    kNrPeriods{5, "nrPeriods"};
+inline constexpr Col<std::uint64_t>    kNrThrottled{6, "nrThrottled"};
+inline constexpr Col<std::uint64_t>    kThrottledUs{7, "throttledUs"};
+inline constexpr Col<std::uint64_t>    kMemCurrent{8, "memCurrent"};
+inline constexpr Col<std::uint64_t>    kMemAnon{9, "memAnon"};
+inline constexpr Col<std::uint64_t>    kMemFile{10, "memFile"};
+inline constexpr Col<std::uint64_t>    kMemKernel{11, "memKernel"};
+inline constexpr Col<std::uint64_t>    kMemShmem{12, "memShmem"};
+inline constexpr Col<std::uint64_t>    kMemSock{13, "memSock"};
+inline constexpr Col<std::uint64_t>    kPgfault{14, "pgfault"};
+inline constexpr Col<std::uint64_t>    kPgmajfault{15, "pgmajfault"};
+inline constexpr Col<std::uint64_t>    kIoReadBytes{16, "ioReadBytes"};
+inline constexpr Col<std::uint64_t>    kIoWriteBytes{17, "ioWriteBytes"};
+inline constexpr Col<std::uint64_t>    kIoReadOps{18, "ioReadOps"};
+inline constexpr Col<std::uint64_t>    kIoWriteOps{19, "ioWriteOps"};
+inline constexpr Col<std::uint64_t>    kMemEventsLow{20, "memEventsLow"};
+inline constexpr Col<std::uint64_t>    kMemEventsHigh{21, "memEventsHigh"};
+inline constexpr Col<std::uint64_t>    kMemEventsMax{22, "memEventsMax"};
+inline constexpr Col<std::uint64_t>    kMemEventsOom{23, "memEventsOom"};
+inline constexpr Col<std::uint64_t>    kMemEventsOomKill{24, "memEventsOomKill"};
+// 由累计计数器换算的每秒速率
+inline constexpr Col<double>           kCpuUsageRate{25, "cpuUsageRate"};      // 微秒/秒
+inline constexpr Col<double>           kThrottledRate{26, "throttledRate"};
+inline constexpr Col<double>           kPgmajfaultRate{27, "pgmajfaultRate"};
+inline constexpr Col<double>           kIoReadBytesRate{28, "ioReadBytesRate"}; // 字节/秒
+inline constexpr Col<double>           kIoWriteBytesRate{29, "ioWriteBytesRate"};
+inline constexpr Col<double>           kIoReadOpsRate{30, "ioReadOpsRate"};
+inline constexpr Col<double>           kIoWriteOpsRate{31, "ioWriteOpsRate"};
+// 速率基线的代际：JobID 复用或作业换了 cgroup 时基线随之重置
+inline constexpr Col<std::uint64_t>    kCgroupIno{32, "cgroupIno"};
+} // namespace cols
+
+const Schema& cgroupSchema();
+
+class CgroupCollector : public ICollector {
+public:
+    ~CgroupCollector() override { deinit(); }
+
+    bool init(const nlohmann::json& cfg) override;
+    CollectResult collect(const Job& job) override;
+    std::vector<CollectResult> collectBatch(const std::vector<JobPtr>& jobs) override;
+    bool batched() const override { return true; }
+    void deinit() noexcept override;
+    void beginTick(const TickContext& ctx) override;
+    bool activity(const CollectResult& result, JobActivity& out) const override;
+
+private:
+    enum CgroupFile { kCpuStat = 0, kMemCurrent, kMemStat, kIoStat, kMemEvents, kFileCount };
+
+    /* 作业对应的 cgroup 目录及其中各文件的 fd，跨周期保持打开 */
+    struct job_cgroup {
+        std::string path;
+        int         anchorPid{-1};     // 解析时使用的 PID，离开作业后重新解析
+        int         dirFd{-1};
+        std::uint64_t ino{};           // dirFd 的 inode
+        int         fds[kFileCount]{-1, -1, -1, -1, -1};
+        std::chrono::steady_clock::time_point resolved{};
+        std::chrono::steady_clock::time_point lastSeen{};
+
+        job_cgroup() = default;
+        job_cgroup(const job_cgroup&) = delete;
+        job_cgroup& operator=(const job_cgroup&) = delete;
+        job_cgroup(job_cgroup&& o) noexcept { *this = std::move(o); }
+        job_cgroup& operator=(job_cgroup&& o) noexcept;
+        ~job_cgroup() { close(); }
+        void close() noexcept;
+    };
+
+    /* tick_cache 非空时同一周期内已读过的 cgroup 直接复用（批量采集） */
+    CollectResult collectLocked(const Job& job, std::unordered_map<std::string, cgroup_info>* tick_cache);
+    static void appendRow(SampleBatch& batch, const cgroup_info& info);
+    bool resolve(const Job& job, job_cgroup& cg);
+    ssize_t readFile(job_cgroup& cg, CgroupFile f, char* buf, std::size_t cap);
+    void sweepIdle();
+
+    static constexpr auto kIdleTimeout = std::chrono::seconds(30);
+
+    std::mutex  mtx_;
+    std::string root_;                  // cgroup v2 挂载点
+    bool        allow_root_{false};     // 作业位于根 cgroup 时是否上报（会得到整机数据）
+    bool        allow_ancestor_{false}; // 作业跨多个 cgroup 时是否按公共祖先上报
+    std::chrono::steady_clock::duration resolve_interval_{std::chrono::seconds(30)};
+    std::unordered_map<int, job_cgroup> jobs_;   // JobID -> cgroup
+    RateEngine  rates_;                 // 按 (JobID, cgroup inode) 维护计数器基线
+    std::chrono::steady_clock::time_point last_sweep_{};
+};
+
+} // namespace cgroup_collector
@@ -5,15 +5,27 @@
 #include <unordered_map>
 #include <functional>
 #include <any>
+#include <memory>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
+#include "collector/host_snapshot.hpp"
+#include "collector/sample_batch.hpp"
+
 #define COLLECTOR_TYPE_PROC "ProcCollector"
+#define COLLECTOR_TYPE_TASKSTATS "TaskstatsCollector"
+#define COLLECTOR_TYPE_SMAPS "SmapsCollector"
+#define COLLECTOR_TYPE_CGROUP "CgroupCollector"
 
 enum class CollectorType {
     ProcCollector,      // 采集 /proc/<pid>/stat
     kStatus,    // 采集 /proc/<pid>/status
     kCmdline,   // 采集 /proc/<pid>/cmdline
-    kFd         // 采集 /proc/<pid>/fd 信息
+    kFd,        // 采集 /proc/<pid>/fd 信息
+    TaskstatsCollector, // 通过 genetlink TASKSTATS 采集
+    SmapsCollector,     // 采集 /proc/<pid>/smaps_rollup
+    CgroupCollector,    // 按作业采集 cgroup v2 统计
+    LensStats           // JobLens 自身各采集器的周期统计
 };
 
 struct Job {
@@ -22,20 +34,52 @@ struct Job {
     std::chrono::system_clock::time_point   JobCreateTime{std::chrono::system_clock::now()};
     std::unordered_map<std::string, void*>  JobInfo;
     std::vector<std::string>                CollectorNames;
+    double                                  SampleFreq{};   // 作业指定的采样频率（Hz），0 表示由采集器决定
 };
 
-using OnFinish = std::function<void(const std::string, const Job&, const std::any, std::chrono::system_clock::time_point)>;
+// 作业可指定的最低采样频率（Hz）。各采集器会回收 30 s 未被采样的基线与缓存，
+// 间隔更长时每次采样都会从头开始，没有速率且要重新解析 cgroup
+inline constexpr double kMinSampleFreq = 1.0 / 30;
+
+inline bool validSampleFreq(double freq) { return freq == 0 || freq >= kMinSampleFreq; }
+
+// JobRegistry 发布的作业快照：发布后不再修改，读者共享同一份而无需拷贝
+using JobPtr = std::shared_ptr<const Job>;
+
+// 一次 collect() 的结果：列式样本批，采集失败或无数据时为空指针
+using CollectResult = SampleBatchPtr;
 
-using CollectResult = std::any;
+// 作业以 JobPtr 传给写入器：写入器异步刷新时只需多持有一个引用，不必拷贝整个 Job
+using OnFinish = std::function<void(const std::string, const JobPtr&, const CollectResult&, std::chrono::system_clock::time_point)>;
+
+// 一个采集周期的上下文：周期开始时构造一次，本周期内所有作业共享
+struct TickContext {
+    std::uint64_t                          seq{};    // 周期序号
+    std::chrono::system_clock::time_point  ts{};     // 周期时间戳
+    std::shared_ptr<const HostSnapshot>    host;     // 整机基准
+    std::shared_ptr<TickArena>             arena;    // 本周期采集结果的分配区
+};
+
+// 作业的累计活跃度，用于自适应采样：相邻两次的差值即该段时间内的 CPU / IO 用量
+struct JobActivity {
+    double        cpuSeconds{};   // 累计 CPU 时间（user + system）
+    std::uint64_t ioBytes{};      // 累计读写字节数
+};
 
 // 统一的可调用签名
 using CollectFunc = std::function<CollectResult(const Job&)>;
+using CollectBatchFunc = std::function<std::vector<CollectResult>(const std::vector<JobPtr>&)>;
 using CollectInitFunc = std::function<bool(const nlohmann::json& config)>;
 using CollectDeinitFunc = std::function<void()>;
+using CollectTickFunc = std::function<void(const TickContext&)>;
+using CollectActivityFunc = std::function<bool(const CollectResult&, JobActivity&)>;
 
 
 struct CollectorHandle {
     CollectInitFunc        init;   
     CollectFunc            collect;
     CollectDeinitFunc      deinit;
+    CollectTickFunc        tick;
+    CollectActivityFunc    activity;
+    CollectBatchFunc       batch;      // 仅实现了批量采集的采集器非空
 };
@@ -8,7 +8,7 @@
 
 namespace collector_utils
 {
-    static std::string get_type_from_name(const std::string& collector_name)
+    inline std::string get_type_from_name(const std::string& collector_name)
     {
         struct Collector {
             std::string name;
@@ -39,7 +39,7 @@ namespace collector_utils
         return "unknown";
     }
 
-    static std::string get_hostname()
+    inline std::string get_hostname()
     {
         static std::string hostname;
         if (hostname.empty()) {
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// 整机级别的采样基准：每个采集周期只读取一次 /proc/stat 与 /proc/meminfo，
+// 同一周期内所有 PID / 作业共用同一个 CPU 分母。
+struct HostSnapshot {
+    long          hz{};            // sysconf(_SC_CLK_TCK)
+    long          numCores{};      // sysconf(_SC_NPROCESSORS_ONLN)
+    std::uint64_t cpuTotal{};      // /proc/stat 首行 cpu 各项之和（jiffies）
+    std::uint64_t memTotalKb{};    // /proc/meminfo MemTotal
+    std::chrono::steady_clock::time_point captured{};
+
+    static HostSnapshot capture();
+};
@@ -1,6 +1,7 @@
 // icollector.h
 #pragma once
 #include <string>
+#include <vector>
 #include "collector_type.h"
 #include "nlohmann/json.hpp"
 
@@ -12,5 +13,22 @@ public:
     virtual bool init(const nlohmann::json& config) = 0;   // 返回 false 表示失败
     virtual CollectResult collect(const Job& job)       = 0;
     virtual void deinit() noexcept                      = 0;
+
+    // 批量采集：一次传入本周期到期的全部作业，结果与 jobs 一一对应。
+    // 默认逐个调用 collect()；需要跨作业分摊固定开销的采集器重写它并让 batched() 返回 true
+    virtual std::vector<CollectResult> collectBatch(const std::vector<JobPtr>& jobs) {
+        std::vector<CollectResult> results;
+        results.reserve(jobs.size());
+        for (const auto& job : jobs) results.push_back(collect(*job));
+        return results;
+    }
+    virtual bool batched() const { return false; }
+
+    // 每个采集周期开始时调用一次（在本周期所有 collect 之前），默认忽略
+    virtual void beginTick(const TickContext& /*ctx*/) {}
+
+    // 从 collect() 的结果中提取作业的累计活跃度，供自适应采样使用；
+    // 返回 false 表示不支持，该采集器上的作业始终按固定频率采集
+    virtual bool activity(const CollectResult& /*result*/, JobActivity& /*out*/) const { return false; }
 };
 
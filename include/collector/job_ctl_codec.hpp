@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+#include "client/joblens_ctl.h"
+#include "collector/collector_type.h"
+#include "collector/job_registry.hpp"
+
+// job_ctl socket 请求包的解码与应答包的编码，协议见 client/joblens_ctl.h。
+// 只做格式校验与字段转换，不接触作业表，JobRegistry::onJobCtl() 按记录顺序执行解码结果
+namespace job_ctl {
+
+struct Request {
+    enum class Kind { Add, Remove, Update };   // Update 对应 update / attach / detach
+    Kind      kind{Kind::Remove};
+    Job       job;      // Add；Remove 只用到 JobID
+    JobUpdate update;   // Update
+};
+
+// 一条记录的解码结果：ack 带回 seq / job_id，记录非法时 status 已填好，req 为空
+struct Record {
+    jl_ack                 ack{};
+    std::optional<Request> req;
+};
+
+// 按记录顺序解码整个请求包。记录头或长度损坏时追加一条 JL_E_PROTO 并停止，
+// 字段缺失或取值非法的记录为 JL_E_INVAL，其余记录的 ack.status 为 JL_OK，待执行后改写
+std::vector<Record> decode(const char* buf, std::size_t len);
+
+// jl_ack_hdr 加 acks，顺序与请求中的记录一致
+std::string encodeAcks(const std::vector<jl_ack>& acks);
+
+} // namespace job_ctl
@@ -21,6 +21,7 @@
 #include "common/config.hpp"
 #include "common/streamer_watcher.hpp"
 #include "common/timer_scheduler.hpp"
+#include "common/work_stealing_executor.hpp"
 #include "writer/writer_manager.hpp"
 #include "utils/nlohmann/json.hpp"
 
@@ -38,7 +39,7 @@ public:
     JobInfoCollector& operator=(JobInfoCollector&&)      = default;
 
     // 对外接口
-    void addCollectFunc(std::string name, std::string config, CollectFunc colloctor_handle,CollectInitFunc init_handle,CollectDeinitFunc deinit_handle);
+    void addCollectFunc(std::string name, std::string config, CollectFunc colloctor_handle,CollectInitFunc init_handle,CollectDeinitFunc deinit_handle,CollectTickFunc tick_handle,CollectActivityFunc activity_handle = {},CollectBatchFunc batch_handle = {});
     void addCallback(OnFinish cb);
     void start();
     void shutdown();
@@ -53,16 +54,52 @@ private:
     void onJobLifecycle(JobEvent ev, Job& job);
     void addJobCollect(const Job& job);
     void startCollector(std::string collector);
-    void addJob2Collector(int jobid, std::string collector);
+    void addJob2Collector(int jobid, double freq, std::string collector);
     void rmJobCollect(const Job& job);
+    void updateJobCollect(const Job& job);
+    /* 各采集器的周期统计（累计值）作为 lens_stats 记录交给写入器，有新的过载时另打警告日志。
+       这类记录描述的是 JobLens 自身而不是某个作业，随附的 Job 是 JobID 为 0 的占位 */
+    void reportStats();
     Config& global_config = Config::instance();
-    TimerScheduler timerScheduler_;
+    TimerScheduler timerScheduler_;   // 到期的采集周期在共享的 WorkStealingExecutor 上执行
+
+    /* 单个作业在某个采集器上的调度状态：每 stride 个周期采集一次 */
+    struct job_sched{
+        double   freq{};            // 作业指定的频率，0 表示自适应（或按采集器频率）
+        uint32_t stride{1};
+        uint64_t next_seq{};        // 下次采集的周期序号
+        uint64_t last_seq{};        // 上次采集的周期序号，用于超出预算时的轮转
+        bool     has_last{false};
+        bool     has_rate{false};
+        JobActivity last{};
+        std::chrono::system_clock::time_point last_ts{};
+        double   cpu_rate{};        // 上一段的 CPU 用量（核）
+        double   io_rate{};         // 上一段的 IO 速率（字节/秒）
+    };
+
+    /* 自适应采样参数：freq 为上限，min_freq 为下限；
+       相邻两段的 CPU / IO 速率变化都低于阈值时步长翻倍，否则回到每周期采集 */
+    struct adaptive_config{
+        bool     enabled{false};
+        uint32_t max_stride{1};
+        double   cpu_delta{0.05};       // 核
+        double   io_delta{1 << 20};     // 字节/秒
+    };
 
     struct collector_state{
         std::vector<int> jobid_list;
-        std::mutex              m_;
-        size_t task_id;
-        bool running;
+        std::unordered_map<int, job_sched> sched;   // JobID -> 调度状态
+        adaptive_config adaptive;
+        std::mutex              m_;      // 保护 jobid_list / sched / adaptive / task_id / running
+        size_t task_id{};
+        bool running{false};
+        uint64_t tick_seq{};
+
+        std::atomic<uint64_t> ticks{};
+        std::atomic<uint64_t> late_ticks{};     // 超过截止时间才结束的周期
+        std::atomic<uint64_t> missed_ticks{};   // 因上一周期未结束而被合并/丢弃的整点
+        std::atomic<uint64_t> skipped_jobs{};   // 因超出预算推迟到下周期的作业次数
+        uint64_t logged_overload{};             // 仅统计定时器访问
     };
 
     struct collector_info
@@ -72,12 +109,34 @@ private:
         CollectFunc collect_handle;
         CollectInitFunc init_handle;
         CollectDeinitFunc deinit_handle;
+        CollectTickFunc tick_handle;
+        CollectActivityFunc activity_handle;
+        CollectBatchFunc batch_handle;   // 为空时逐作业调用 collect_handle
     };
-    
+
+    /* 采集单个作业并分发给写入器，可在任意线程上并行调用 */
+    bool collectOne(const collector_info& info, const std::string& collector_name, int jobid, bool expand,
+                    std::chrono::system_clock::time_point ts, JobActivity& activity);
+    JobPtr resolveJob(int jobid, bool expand);
+    /* 把采集结果交给写入器，并提取作业活跃度（采集器支持时返回 true） */
+    bool dispatch(const collector_info& info, const std::string& collector_name, const JobPtr& job,
+                  const CollectResult& ret, std::chrono::system_clock::time_point ts, JobActivity& activity);
+    /* 根据本次采集到的活跃度决定作业下一次采集的周期 */
+    static void reschedule(job_sched& s, const adaptive_config& cfg, int freq, uint64_t seq,
+                           std::chrono::system_clock::time_point ts, const JobActivity* activity);
+
 
     std::mutex              m_;
     std::unordered_map<std::string, collector_info> collector_info_dict;
     std::unordered_map<std::string, collector_state> collector_state_dict;
     std::vector<OnFinish>   finishCallbacks_;
     bool                    running_ = false;
+    bool                    track_descendants_ = true;   // 自动跟踪作业的后代进程
+    TimerScheduler::MissedTickPolicy missed_tick_policy_ = TimerScheduler::MissedTickPolicy::Coalesce;
+    double                  tick_budget_ = 0.8;   // 每周期的时间预算占周期长度的比例，0 表示不限制
+    size_t                  stats_task_{};
+    static constexpr std::chrono::seconds kStatsInterval{60};
+    static constexpr std::size_t kBatchChunk = 64;   // 批量采集每次调用的作业数，块之间检查周期预算
+    size_t                  reap_task_{};
+    double                  liveness_interval_ = 1.0;   // 扫描模式下检查作业进程是否全部退出的间隔（秒）
 };
\ No newline at end of file
@@ -8,7 +8,7 @@ struct Job;
 enum class JobEvent {
     Added,
     Removed,
-    Updated   // 预留，方便以后做属性热更新
+    Updated   // 作业的 PID、采集器或频率被 update / attach / detach 修改
 };
 
 // 回调签名：事件类型 + Job 常量引用
@@ -1,20 +1,49 @@
 // job_registry.h
 #pragma once
+#include <deque>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <shared_mutex>
+#include <memory>
 #include <vector>
 #include <functional>
 #include <optional>
 #include "common/streamer_watcher.hpp"
 #include "collector/collector_type.h"
+#include "collector/pid_watcher.hpp"
+#include "collector/proc_event_source.hpp"
 #include "job_lifecycle_event.h"
 
 
 
+// 对已登记作业的增量修改，对应作业控制消息中的 update / attach / detach：
+//   Replace 用给出的字段替换原值；Attach / Detach 把给出的 PID、采集器加入或移出作业。
+// 未给出的字段保持不变
+struct JobUpdate {
+    enum class Mode { Replace, Attach, Detach };
+
+    int                                     JobID{};
+    Mode                                    mode{Mode::Replace};
+    std::optional<std::vector<int>>         JobPIDs;
+    std::optional<std::vector<std::string>> CollectorNames;
+    std::optional<double>                   SampleFreq;   // 仅 Replace
+};
+
+// 作业表采用 RCU 式发布：写者（增删作业、PID 挂载/摘除）在互斥锁内复制出新表并整体替换，
+// 读者只原子地取一次表指针，拿到的作业快照是不可变、引用计数的 JobPtr，查找时不拷贝 Job。
+// 注意 libstdc++ 的 shared_ptr 原子操作内部用一个很短的自旋锁保护引用计数，读者并非无等待，
+// 但只与同一时刻的指针交换竞争，不会等写者复制整张表。
+// 进程事件（fork / exit）带来的 PID 变更先挂起，每批事件合并成一次发布，而不是每个事件复制一次表。
 class JobRegistry {
 public:
+    using JobMap = std::unordered_map<int, JobPtr>;   // key = JobID
+
     static JobRegistry& instance();          // 仍保留单例，方便迁移；也可由 main() 构造
     ~JobRegistry(){
+        if (proc_events_) proc_events_->stop();
+        if (pid_watcher_) pid_watcher_->stop();
+        if (job_ctl_) job_ctl_->stop();
         job_opt_->stop();
     };
 
@@ -22,19 +51,93 @@ public:
     JobRegistry(const JobRegistry&)            = delete;
     JobRegistry& operator=(const JobRegistry&) = delete;
 
+    // 增删改作业的结果。同一个 PID 可以同时属于多个作业（与采集器按 PID 去重的行为一致），
+    // 无论是否有 pidfd / proc connector，登记结果都相同
+    enum class OpResult { Applied, Duplicate, NotFound };
+
     // Job 增删
     void addJob(Job job);
     void delJob(int jobID);
-    const Job* findJob(int jobID) const;
-    std::vector<Job> snapshot() const;
+    // 原地修改作业并发出 JobEvent::Updated；作业不存在时返回 NotFound，
+    // 修改后不再有任何 PID 的作业直接移除
+    OpResult updateJob(const JobUpdate& update);
+    // 不存在时返回空指针
+    JobPtr findJob(int jobID) const;
+    // 当前发布的整张作业表
+    std::shared_ptr<const JobMap> snapshot() const;
+
+    // 扫描模式下的存活检查：根进程及其后代全部退出的作业被移除。
+    // 由定时器周期调用，不在查找路径上；事件模式下退出由 proc connector 实时处理，直接返回。
+    // pidfd 可用时根进程的退出已实时处理，这里只剩“根进程已退出、后代仍在运行”的作业需要探测
+    void reapExited();
+
+    // 进程事件驱动的 PID 挂载 / 摘除；作业的最后一个 PID 退出时作业被移除
+    void attachPid(int parentPid, int childPid);
+    void detachPid(int pid);
+    // 是否由 proc connector 实时维护作业的进程树（否则按周期扫描 /proc）
+    bool eventTracking() const { return proc_events_.has_value(); }
 
     // 生命周期回调注册
     void addLifecycleCb(JobLifecycleCb cb);
 
 private:
+    /* 作业控制消息中的 add / remove，同一批内按到达顺序执行；remove 只用到 job.JobID */
+    struct JobOp {
+        enum class Kind { Add, Remove };
+        Kind kind;
+        Job  job;
+        OpResult result{OpResult::Applied};   // applyOps() 回填
+    };
+
     JobRegistry();
+    /* buf 为若干以换行分隔的 JSON 消息，一次唤醒读到的内容作为一批处理 */
+    void onJobOpt(const char* buf, std::size_t len);
+    /* job_ctl socket 的一个请求包，协议见 client/joblens_ctl.h；返回应答包 */
+    std::string onJobCtl(const char* buf, std::size_t len);
+    void startJobCtl();
+    /* 整批增删只取一次写锁、只发布一次作业表，回调与 pidfd 监视在锁外按顺序进行 */
+    void applyOps(std::vector<JobOp>& ops);
+    /* 投递 events_ 中排队的生命周期事件；返回时本线程登记的事件都已投递（回调内重入时除外） */
+    void deliverEvents();
+    void startProcEvents();
+    void startPidWatcher();
+    void onPidExit(int pid);
+    /* 调用方持有 mtx_：登记 / 撤销 jobID 对 pid 的归属。
+       addOwner 返回此前是否未归属该作业；dropOwner 返回 pid 是否已不再属于任何作业 */
+    bool addOwner(int pid, int jobID);
+    bool dropOwner(int pid, int jobID);
+    void seedDescendants(const std::vector<int>& jobIDs);
+    void resync();
+    /* 进程事件只在 mtx_ 内登记 pid_owner_ 与 pid_deltas_，返回是否有变更；
+       flushPidChanges() 把所有挂起的变更合并成一次发布，作业的 PID 全部退出时移除作业 */
+    bool recordAttach(int parentPid, int childPid);
+    bool recordDetach(int pid);
+    void flushPidChanges();
+    /* 写者在 mtx_ 内调用：复制当前表，交给 fn 修改后发布 */
+    template <typename Fn>
+    void update(Fn&& fn);
+
     std::optional<StreamWatcher> job_opt_;
-    mutable std::shared_mutex              mtx_;
-    std::unordered_map<int, Job>           jobs_;   // key = JobID
+    std::optional<StreamWatcher> job_ctl_;       // 可选的 Unix 域 socket 入口，带逐条应答
+    std::optional<ProcEventSource> proc_events_;
+    std::optional<PidWatcher>      pid_watcher_;   // 扫描模式下监视作业根进程的退出
+    mutable std::shared_mutex              mtx_;         // 只在写者之间互斥，保护 pid_owner_ / anchors_ / events_
+    std::shared_ptr<const JobMap>          jobs_{std::make_shared<const JobMap>()};   // 用 atomic_load/atomic_store 访问
+    std::unordered_map<int, std::vector<int>> pid_owner_;   // PID -> 所属的 JobID（通常只有一个）
+    std::unordered_set<int>                anchors_;     // 已退出、仅作展开锚点保留的根 PID，离开 pid_owner_ 时一并移除
+    struct pid_delta {
+        std::vector<int> added;
+        std::vector<int> removed;
+    };
+    std::unordered_map<int, pid_delta>     pid_deltas_;  // JobID -> 尚未发布的 PID 变更
+    /* 生命周期事件在修改作业表的同一临界区内入队（受 mtx_ 保护），因此队列顺序就是修改顺序；
+       FIFO、socket、pidfd、proc connector 与定时器线程都可能修改作业，投递由 cb_mtx_ 串行化，
+       同一作业的 Removed 不会先于 Added 到达回调 */
+    struct lifecycle_event {
+        JobEvent event;
+        JobPtr   job;
+    };
+    std::deque<lifecycle_event>            events_;
+    std::mutex                             cb_mtx_;      // 串行化回调投递，保护 cbs_
     std::vector<JobLifecycleCb>            cbs_;
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LOGGER_TRACE
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// 基于 pidfd 的进程退出通知：每个被监视的 PID 持有一个 pidfd_open 得到的描述符，
+// 统一挂在一个 epoll 上，进程退出时描述符变为可读，onExit 对每个 PID 恰好回调一次。
+// pidfd 绑定的是开始监视时的那个进程本身而不是 PID 号：即使进程被回收后 PID 号被复用，
+// 通知的也只是原进程的退出，不会误报到新进程上。
+// 需要 Linux 5.3+；start() 失败时调用方应回退到周期性探测。
+class PidWatcher {
+public:
+    explicit PidWatcher(std::function<void(int pid)> onExit);
+    ~PidWatcher();
+
+    PidWatcher(const PidWatcher&)            = delete;
+    PidWatcher& operator=(const PidWatcher&) = delete;
+
+    bool start();   // 内核不支持 pidfd_open 时返回 false
+    void stop();
+
+    enum class Watch {
+        Watching,   // 已在监视（含之前就在监视中）
+        Exited,     // 进程已不存在（ESRCH）
+        Failed      // 其他错误（fd 耗尽、内存不足、epoll_ctl 失败等），进程状态未知
+    };
+    // 开始监视 pid
+    Watch watch(int pid);
+    // 停止监视，不触发 onExit
+    void unwatch(int pid);
+    bool watching(int pid) const;
+    std::size_t size() const;
+
+private:
+    void loop();
+
+    std::function<void(int)>     onExit_;
+    int                          epfd_{-1};
+    int                          wakefd_{-1};   // eventfd，stop() 时唤醒 epoll_wait
+    std::thread                  thread_;
+    std::atomic<bool>            stop_flag_{false};
+    mutable std::mutex           m_;
+    std::unordered_map<int, int> fds_;          // PID -> pidfd
+};
@@ -11,7 +11,11 @@
 #include <optional>
 #include <fmt/core.h>
 #include <memory>
+#include <array>
+#include <mutex>
 #include "collector/collector_type.h"
+#include "collector/procfs_reader.hpp"
+#include "collector/rate_engine.hpp"
 #include "icollector.h"
 #include <any>
 // 前置声明，降低头文件耦合
@@ -19,6 +23,17 @@ class Job;
 
 namespace proc_collector {
 
+/* 单线程采样，仅在 per_thread 模式下填充 */
+struct thread_info {
+    int         tid{};
+    std::string name;
+    char        state{'?'};
+    int         processor{-1};     // 最近一次运行所在的 CPU
+    double      cpuPercent{};
+    unsigned long long utime{};
+    unsigned long long stime{};
+};
+
 struct proc_info {
     int8_t      type{int8_t(CollectorType::ProcCollector)};
     int         pid{};
@@ -36,27 +51,102 @@ struct proc_info {
     std::size_t memoryRss{};       // 字节
     double      memoryPercent{};
     int         numThreads{};
-    int         ioReadCount{};
-    int         ioWriteCount{};
-    int         netConnCount{};
+    std::uint64_t ioReadCount{};   // 累计 read_bytes
+    std::uint64_t ioWriteCount{};  // 累计 write_bytes
+    int         netConnCount{};    // socket 数
+    int         fdCount{};
+    int         pipeCount{};
+    int         fileCount{};
+    int         anonInodeCount{};
     std::string status{"unknown"};
+    std::vector<thread_info> threads;
+
+    /* 作为每线程复用的暂存区：清零数值，保留字符串与线程数组的容量 */
+    void clear();
 };
 
+// collect() 输出的列，顺序即 Schema 中的顺序
+namespace proc_cols {
+inline constexpr Col<std::int64_t>     kPid{0, "pid"};
+inline constexpr Col<std::string_view> kName{1, "name"};
+inline constexpr Col<std::int64_t>     kPpid{2, "ppid"};
+inline constexpr Col<double>           kCpuPercent{3, "cpuPercent"};
+inline constexpr Col<double>           kCpuTimeSec{4, "cpuTimeSec"};        // 累计 user + system 时间
+inline constexpr Col<std::uint64_t>    kMemoryRss{5, "memoryRss"};
+inline constexpr Col<double>           kMemoryPercent{6, "memoryPercent"};
+inline constexpr Col<std::int64_t>     kNumThreads{7, "numThreads"};
+inline constexpr Col<std::uint64_t>    kIoReadCount{8, "ioReadCount"};
+inline constexpr Col<std::uint64_t>    kIoWriteCount{9, "ioWriteCount"};
+inline constexpr Col<std::int64_t>     kNetConnCount{10, "netConnCount"};
+inline constexpr Col<std::int64_t>     kFdCount{11, "fdCount"};
+inline constexpr Col<std::int64_t>     kPipeCount{12, "pipeCount"};
+inline constexpr Col<std::int64_t>     kFileCount{13, "fileCount"};
+inline constexpr Col<std::int64_t>     kAnonInodeCount{14, "anonInodeCount"};
+inline constexpr Col<std::string_view> kStatus{15, "status"};
+inline constexpr Col<std::uint64_t>    kStarttime{16, "starttime"};         // 区分 PID 复用
+inline constexpr Col<double>           kIoReadRate{17, "ioReadRate"};       // 字节/秒
+inline constexpr Col<double>           kIoWriteRate{18, "ioWriteRate"};
+} // namespace proc_cols
+
+// per_thread 模式下的线程子表，挂在所属进程行下
+namespace thread_cols {
+inline constexpr Col<std::int64_t>     kTid{0, "tid"};
+inline constexpr Col<std::string_view> kName{1, "name"};
+inline constexpr Col<std::string_view> kState{2, "state"};
+inline constexpr Col<std::int64_t>     kProcessor{3, "processor"};
+inline constexpr Col<double>           kCpuPercent{4, "cpuPercent"};
+inline constexpr Col<std::uint64_t>    kUtime{5, "utime"};
+inline constexpr Col<std::uint64_t>    kStime{6, "stime"};
+} // namespace thread_cols
+
+const Schema& procSchema();
+
 class ProcCollector : public ICollector {
 public:
     bool init(const nlohmann::json& cfg) override;
     CollectResult collect(const Job& job) override;
     void deinit() noexcept override;
+    void beginTick(const TickContext& ctx) override;
+    bool activity(const CollectResult& result, JobActivity& out) const override;
 private:
-    std::any impl_collect(const Job& job);
-    std::unique_ptr<proc_info> snapshotOf(int pid);
+    SampleBatchPtr impl_collect(const Job& job);
+    static void appendRow(SampleBatch& batch, const proc_info& info);
+
+    /* 长时间未被采样的 PID（已退出或离开作业）在此之后释放句柄与基线 */
+    static constexpr auto kIdleTimeout = std::chrono::seconds(30);
 
     struct pid_state{
         unsigned long long lastTotal{};
         unsigned long long lastProc{};
+        unsigned long long starttime{};
+        double lastPercent{};
+        std::chrono::steady_clock::time_point lastSeen{};
     };
 
-    std::unordered_map<int, pid_state> pid_state_dict;
+    /* 按 PID 分片的采集状态：同一周期内多个作业并行采集，只在分片内互斥 */
+    struct shard {
+        std::mutex m;
+        procfs::PidHandleCache handle_cache;
+        std::unordered_map<int, pid_state> pid_state_dict;
+        std::unordered_map<int, pid_state> tid_state_dict;   // per_thread 模式，按 tid
+    };
+    static constexpr std::size_t kShards = 16;
+    shard& shardOf(int pid) { return shards_[static_cast<unsigned>(pid) % kShards]; }
+
+    bool snapshotOf(int pid, const HostSnapshot& host, proc_info& info);
+    void sweepIdle();
+    void snapshotThreads(shard& s, procfs::PidHandle& h, std::int64_t num_threads,
+                         const HostSnapshot& host, proc_info& info);
+
+    /* 根据上一次的基线计算 CPU 使用率并推进基线，pid 与 tid 共用 */
+    static double cpuPercentOf(pid_state& cu, unsigned long long starttime, unsigned long long currProc,
+                               const HostSnapshot& host);
+
+    std::array<shard, kShards> shards_;
+    RateEngine rates_;
+    bool per_thread_{false};
+    std::chrono::steady_clock::time_point last_sweep_{};
+    std::shared_ptr<const HostSnapshot> host_;   // 当前周期的整机快照，用 atomic_load/atomic_store 访问
 };
 
 
@@ -0,0 +1,42 @@
+#pragma once
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LOGGER_TRACE
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// 基于内核 proc connector（NETLINK_CONNECTOR / CN_IDX_PROC）的进程事件源。
+// 只上报进程级（tgid）事件，线程的创建与退出会被忽略。
+// 需要 CAP_NET_ADMIN；start() 失败时调用方应回退到扫描 /proc。
+class ProcEventSource {
+public:
+    struct Handlers {
+        std::function<void(int parent, int child)> onFork;
+        std::function<void(int pid)>               onExec;
+        std::function<void(int pid)>               onExit;
+        // 接收缓冲溢出（ENOBUFS），期间的事件已丢失，调用方需要做一次全量校正
+        std::function<void()>                      onLost;
+        // 一批事件处理完（接收队列已读空，或连续处理了 kMaxBatch 个包）后调用，调用方可在此合并发布
+        std::function<void()>                      onDrained;
+    };
+
+    explicit ProcEventSource(Handlers h);
+    ~ProcEventSource();
+
+    ProcEventSource(const ProcEventSource&)            = delete;
+    ProcEventSource& operator=(const ProcEventSource&) = delete;
+
+    bool start();   // 订阅并启动接收线程，失败返回 false
+    void stop();
+
+private:
+    static constexpr int kMaxBatch = 64;   // 事件持续涌入时，至多这么多个包就调用一次 onDrained
+
+    bool subscribe(bool on);
+    void loop();
+
+    Handlers          h_;
+    int               sock_{-1};
+    std::thread       thread_;
+    std::atomic<bool> stop_flag_{false};
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 整机进程树（ppid -> children 索引），用于把作业的根 PID 展开为完整的后代进程树。
+//   - 每次 refresh 只扫描一次 /proc，且只为新出现的 PID 读取 stat（增量维护）
+//   - 多个采集器在同一周期内调用 refresh 时，由 min_interval 合并为一次扫描
+//   - 记录的是进程首次被观察到时的父进程；中间进程退出后，
+//     其子进程即使被 init/subreaper 收养也仍然归属原来的作业
+//   - 作业根进程及曾被 expand / hasLiveDescendant 找到的后代每次扫描都核对 starttime，
+//     两次扫描之间被复用的 PID 按“旧进程退出 + 新进程出现”处理
+class ProcessTree {
+public:
+    static ProcessTree& instance();
+
+    ProcessTree(const ProcessTree&)            = delete;
+    ProcessTree& operator=(const ProcessTree&) = delete;
+
+    // 距上次扫描不足 min_interval 时直接返回
+    void refresh(std::chrono::steady_clock::duration min_interval);
+
+    // 返回 roots 及其所有存活的后代（去重，roots 在前）
+    std::vector<int> expand(const std::vector<int>& roots) const;
+
+    // roots 的后代中是否还有存活进程（roots 自身不计）
+    bool hasLiveDescendant(const std::vector<int>& roots) const;
+
+    std::size_t size() const;
+
+private:
+    ProcessTree() = default;
+
+    struct Node {
+        int           ppid{};
+        std::uint64_t starttime{};
+        std::uint64_t gen{};
+    };
+
+    void link(int pid, const Node& node);
+    void unlinkDead(int pid, const Node& node);
+    template <typename Visit>
+    void walk(const std::vector<int>& roots, Visit&& visit) const;
+
+    mutable std::shared_mutex                    mtx_;
+    std::unordered_map<int, Node>                nodes_;      // 存活进程
+    std::unordered_map<int, std::vector<int>>    children_;   // ppid -> 子进程（父进程可能已退出）
+    std::uint64_t                                gen_{};
+
+    mutable std::mutex                           reach_mtx_;  // 在 mtx_ 之后获取
+    mutable std::unordered_set<int>              reached_;    // 出现在作业树中的存活进程，扫描时核对 starttime
+
+    std::mutex                                   scan_mtx_;
+    std::chrono::steady_clock::time_point        last_scan_{};
+    std::vector<int>                             scan_pids_;  // 复用的扫描缓冲
+    std::vector<int>                             new_pids_;
+};
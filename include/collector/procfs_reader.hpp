@@ -0,0 +1,255 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+// procfs 读取与解析工具：
+//   - 使用 pread 读入每线程复用的缓冲区，稳态路径不做任何堆分配
+//   - 字段解析全部是手写的整数扫描器，不依赖 iostream / locale
+namespace procfs {
+
+/* 单个 procfs 文件读缓冲的容量；/proc/<pid>/status 通常 < 2KB */
+constexpr std::size_t kReadBufSize = 16 * 1024;
+
+/* 每线程复用的读缓冲区 */
+char* thread_buffer();
+
+/* 从偏移 0 开始把 fd 的内容读入 buf，返回读到的字节数，失败返回 -1 */
+ssize_t pread_all(int fd, char* buf, std::size_t cap);
+
+/* open + pread + close，失败返回 -1 */
+ssize_t read_file(const char* path, char* buf, std::size_t cap);
+
+/* openat 的失败是否持久：文件不存在或无权限不会自行恢复，应记为不可用；
+   EMFILE / ENFILE / ENOMEM 等只是一时的资源紧张，下次再试 */
+bool open_failed_for_good(int err);
+
+/* ---------- 扫描器 ---------- */
+
+inline void skip_spaces(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+}
+
+/* 解析一个无符号十进制整数（允许前导空白），成功时 p 指向数字之后 */
+inline bool scan_u64(const char*& p, const char* end, std::uint64_t& out) {
+    skip_spaces(p, end);
+    if (p >= end || *p < '0' || *p > '9') return false;
+    std::uint64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + static_cast<std::uint64_t>(*p - '0');
+        ++p;
+    }
+    out = v;
+    return true;
+}
+
+inline bool scan_i64(const char*& p, const char* end, std::int64_t& out) {
+    skip_spaces(p, end);
+    bool neg = false;
+    if (p < end && *p == '-') { neg = true; ++p; }
+    std::uint64_t v = 0;
+    if (!scan_u64(p, end, v)) return false;
+    out = neg ? -static_cast<std::int64_t>(v) : static_cast<std::int64_t>(v);
+    return true;
+}
+
+/* 跳过 n 个以空格分隔的字段 */
+inline bool skip_fields(const char*& p, const char* end, int n) {
+    for (int i = 0; i < n; ++i) {
+        skip_spaces(p, end);
+        if (p >= end) return false;
+        while (p < end && *p != ' ' && *p != '\n') ++p;
+    }
+    return true;
+}
+
+/* 在 [begin,end) 中查找以 key 开头的行，返回 key 之后的位置；找不到返回 nullptr */
+const char* find_key(const char* begin, const char* end, const char* key, std::size_t key_len);
+
+/* ---------- 文件结构 ---------- */
+
+/* /proc/<pid>/stat 中关心的字段，编号见 proc(5) */
+struct StatFields {
+    int           pid{};
+    char          comm[16]{};        // 内核 TASK_COMM_LEN = 16，含结尾 '\0'
+    std::size_t   comm_len{};
+    char          state{'?'};        // 3
+    int           ppid{};            // 4
+    std::uint64_t utime{};           // 14
+    std::uint64_t stime{};           // 15
+    std::int64_t  num_threads{};     // 20
+    std::uint64_t starttime{};       // 22
+    std::int64_t  rss_pages{};       // 24
+    int           processor{-1};     // 39
+};
+
+struct StatmFields {
+    std::uint64_t size_pages{};
+    std::uint64_t resident_pages{};
+};
+
+struct StatusFields {
+    std::uint64_t vm_rss_kb{};
+    std::int64_t  threads{};
+};
+
+struct IoFields {
+    std::uint64_t read_bytes{};
+    std::uint64_t write_bytes{};
+};
+
+/* /proc/<pid>/smaps_rollup，单位 KB；Pss_Anon/File/Shmem 需要 5.7+ 内核 */
+struct SmapsRollupFields {
+    std::uint64_t rss_kb{};
+    std::uint64_t pss_kb{};
+    std::uint64_t pss_anon_kb{};
+    std::uint64_t pss_file_kb{};
+    std::uint64_t pss_shmem_kb{};
+    std::uint64_t private_clean_kb{};
+    std::uint64_t private_dirty_kb{};
+    std::uint64_t anonymous_kb{};
+    std::uint64_t swap_kb{};
+    std::uint64_t swap_pss_kb{};
+};
+
+bool parse_stat  (const char* buf, std::size_t len, StatFields& out);
+bool parse_statm (const char* buf, std::size_t len, StatmFields& out);
+bool parse_status(const char* buf, std::size_t len, StatusFields& out);
+bool parse_io    (const char* buf, std::size_t len, IoFields& out);
+bool parse_smaps_rollup(const char* buf, std::size_t len, SmapsRollupFields& out);
+
+/* /proc/meminfo 的 MemTotal（KB） */
+bool parse_meminfo_total(const char* buf, std::size_t len, std::uint64_t& kb);
+
+/* /proc/stat 首行 cpu 各项之和（jiffies） */
+bool parse_cpu_total(const char* buf, std::size_t len, std::uint64_t& jiffies);
+
+/* /proc/stat 的 btime：系统启动时刻（Unix 时间，秒） */
+bool parse_boot_time(const char* buf, std::size_t len, std::uint64_t& secs);
+
+/* 用 getdents64 列出 dir_fd 下的数字目录项（fd 编号、tid 等），结果升序 */
+bool list_numeric_dir(int dir_fd, std::vector<int>& out);
+
+/* ---------- /proc/<pid>/fd 统计 ---------- */
+
+struct FdCensus {
+    std::uint32_t total{};
+    std::uint32_t sockets{};
+    std::uint32_t pipes{};
+    std::uint32_t files{};        // 指向文件系统路径（含设备文件）
+    std::uint32_t anonInodes{};   // eventfd / epoll / timerfd 等
+    std::uint32_t other{};
+};
+
+/* 上一次统计的结果；fd 编号与分类按编号升序保存 */
+struct FdCensusState {
+    std::vector<int>          fds;
+    std::vector<std::uint8_t> kinds;
+    FdCensus                  last;
+};
+
+/* 用 getdents64 列出 fd_dir（/proc/<pid>/fd 的目录 fd）。
+   state 不为空时：fd 列表与上次完全相同则直接复用上次结果；
+   否则只对新出现的 fd 编号做 readlinkat。
+   注意：同一编号在两次采样之间被关闭又打开成其他对象时会沿用旧分类。 */
+bool census_fds(int fd_dir, FdCensusState* state, FdCensus& out);
+
+/* ---------- /proc/<pid>/task 线程 ---------- */
+
+struct ThreadStat {
+    int        tid{};
+    StatFields stat;
+};
+
+/* ---------- 长期打开的 /proc/<pid> 句柄 ---------- */
+
+enum class PidFile : int {
+    Stat = 0,
+    Statm,
+    Status,
+    Io,
+    SmapsRollup,
+    Count
+};
+
+/* 持有 /proc/<pid> 目录 fd，按需 openat 各文件并在多次采样之间保持打开。
+   进程退出后旧 fd 上的 pread 会失败（ESRCH），据此判定句柄失效；
+   PID 复用通过 /proc/<pid>/stat 的 starttime 识别。 */
+class PidHandle {
+public:
+    PidHandle() = default;
+    ~PidHandle() { close(); }
+
+    PidHandle(const PidHandle&)            = delete;
+    PidHandle& operator=(const PidHandle&) = delete;
+    PidHandle(PidHandle&& o) noexcept { *this = std::move(o); }
+    PidHandle& operator=(PidHandle&& o) noexcept;
+
+    bool open(int pid);
+    void close() noexcept;
+    bool valid() const { return dir_fd_ >= 0; }
+    int  pid() const { return pid_; }
+    int  dirFd() const { return dir_fd_; }
+
+    /* 读取某个文件，返回字节数；文件不存在或无权限返回 -1（不会反复重试），
+       fd 耗尽（EMFILE / ENFILE）返回 -1 但下次仍会尝试打开，
+       进程已退出也返回 -1，调用方应随后丢弃此句柄 */
+    ssize_t read(PidFile f, char* buf, std::size_t cap);
+
+    /* 统计 /proc/<pid>/fd，目录 fd 与上次的分类结果都缓存在句柄内 */
+    bool fdCensus(FdCensus& out);
+
+    /* 读取每个线程的 /proc/<pid>/task/<tid>/stat。task 目录 fd 与线程列表跨周期缓存，
+       只有线程数与 num_threads 不符或某个线程已退出时才重新列目录；
+       各线程的 stat 不保持打开，句柄占用的 fd 数与线程数无关 */
+    bool readThreads(std::int64_t num_threads, std::vector<ThreadStat>& out);
+
+    std::uint64_t starttime{};   // 0 表示尚未确认
+    std::chrono::steady_clock::time_point last_used{};
+
+private:
+    static constexpr int kUnavailable = -2;   // openat 返回 ENOENT / EACCES，不再尝试
+
+    bool relistThreads();
+    ssize_t readThreadStat(std::size_t i, char* buf, std::size_t cap);
+    void closeThreads() noexcept;
+
+    int pid_{-1};
+    int dir_fd_{-1};
+    int fds_[static_cast<int>(PidFile::Count)]{-1, -1, -1, -1, -1};
+    int fd_dir_fd_{-1};
+    FdCensusState fd_state_;
+    int task_dir_fd_{-1};
+    std::vector<int> tids_;       // 升序
+};
+
+/* PID -> PidHandle 缓存，超出容量后调用方应回退到一次性 open/close 路径 */
+class PidHandleCache {
+public:
+    explicit PidHandleCache(std::size_t capacity = 4096) : capacity_(capacity) {}
+
+    void setCapacity(std::size_t capacity) { capacity_ = capacity; }
+    std::size_t size() const { return handles_.size(); }
+
+    /* 取得（必要时打开）pid 的句柄；进程不存在或缓存已满返回 nullptr */
+    PidHandle* acquire(int pid);
+
+    /* 进程退出或 PID 被复用时丢弃句柄 */
+    void invalidate(int pid);
+
+    /* 关闭超过 idle 时长未被使用的句柄（PID 已离开所有作业） */
+    void sweep(std::chrono::steady_clock::duration idle);
+
+    void clear() { handles_.clear(); }
+
+private:
+    std::size_t capacity_;
+    std::unordered_map<int, PidHandle> handles_;
+};
+
+} // namespace procfs
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "collector/sample_batch.hpp"
+
+// 把单调递增的累计计数器（读写字节、上下文切换、延迟总量……）换算成每秒速率。
+// 基线按（实体 ID、代际、计数器）保存，时间间隔取两次读数之间实际经过的时间，
+// 而不是名义上的采样周期。
+//  - 代际变化（PID 被复用，starttime 不同）视为新实体，从新基线开始；
+//  - 计数器变小视为归零重启（例如 cgroup 被重建），本次增量按当前值计算；
+//  - 首次出现的键没有速率，速率列保持 0。
+// 采集器在 Schema 中用 withRates() 声明计数器列，每次采集后调用 apply() 即可。
+class RateEngine {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Key {
+        std::int64_t  id{};
+        std::uint64_t generation{};
+        std::uint32_t metric{};   // 计数器列在 Schema 中的下标
+        bool operator==(const Key& o) const {
+            return id == o.id && generation == o.generation && metric == o.metric;
+        }
+    };
+
+    // 按 batch 的 Schema（及子表 Schema）声明的计数器逐行填充速率列；now 为本次读数的时间
+    void apply(SampleBatch& batch, Clock::time_point now);
+
+    // 单个计数器的速率（每秒增量）；首次出现的键返回 std::nullopt
+    std::optional<double> rate(const Key& key, std::uint64_t value, Clock::time_point now);
+
+    // 释放 idle 时间内没有更新过的基线（已退出的进程、已结束的作业），内部限频
+    void sweep(Clock::duration idle);
+    void clear();
+
+private:
+    /* 同一周期内再次读到同一个键（PID 同属多个作业）时间隔太短，沿用上次的速率 */
+    static constexpr auto kMinInterval = std::chrono::milliseconds(10);
+
+    struct KeyHash {
+        std::size_t operator()(const Key& k) const noexcept {
+            std::uint64_t h = static_cast<std::uint64_t>(k.id) * 0x9e3779b97f4a7c15ULL;
+            h ^= k.generation + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h ^= static_cast<std::uint64_t>(k.metric) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            return static_cast<std::size_t>(h);
+        }
+    };
+
+    struct baseline {
+        std::uint64_t     value{};
+        Clock::time_point ts{};
+        double            rate{};
+        bool              hasRate{false};
+    };
+
+    /* 按实体 ID 分片：多个作业并行采集时只在分片内互斥 */
+    struct shard {
+        std::mutex m;
+        std::unordered_map<Key, baseline, KeyHash> baselines;
+    };
+    static constexpr std::size_t kShards = 16;
+    shard& shardOf(std::int64_t id) { return shards_[static_cast<std::uint64_t>(id) % kShards]; }
+
+    void applyOne(SampleBatch& batch, Clock::time_point now);
+
+    std::array<shard, kShards> shards_;
+    std::mutex                 sweep_m_;
+    Clock::time_point          last_sweep_{};
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// 列式采样批：一个 collect() 结果的全部样本按列存放（struct-of-arrays），
+// 列的名称与类型由 Schema 描述。采集器按带类型的列句柄（Col<T>）填充，
+// 写入器按 Schema 遍历，整条路径上没有 std::any、没有逐行的堆分配。
+// 列存储从构造时所在周期的 TickArena 分配，字符串列保存驻留表或 arena 中的视图。
+
+class TickArena;
+
+enum class ColumnType : std::uint8_t {
+    Int64 = 0,
+    UInt64,
+    Double,
+    String,
+    Bool,
+};
+
+template <typename T> struct column_type_of;
+template <> struct column_type_of<std::int64_t>  { static constexpr ColumnType value = ColumnType::Int64; };
+template <> struct column_type_of<std::uint64_t> { static constexpr ColumnType value = ColumnType::UInt64; };
+template <> struct column_type_of<double>        { static constexpr ColumnType value = ColumnType::Double; };
+template <> struct column_type_of<std::string_view> { static constexpr ColumnType value = ColumnType::String; };
+template <> struct column_type_of<bool>          { static constexpr ColumnType value = ColumnType::Bool; };
+
+// 带类型的列句柄：下标即该列在 Schema 中的位置，类型在编译期确定
+template <typename T>
+struct Col {
+    std::size_t index;
+    const char* name;
+};
+
+struct ColumnDesc {
+    const char* name;
+    ColumnType  type;
+    std::size_t index;
+};
+
+// 单调递增的累计计数器列（UInt64）及由它派生的每秒速率列（Double）
+struct CounterDesc {
+    std::size_t counter;
+    std::size_t rate;
+};
+
+// Schema 中计数器的声明，由 RateEngine 逐行换算成速率。
+// 基线按（实体、代际、计数器）分别维护：实体列是 pid / jobId 等 Int64 列，
+// 代际列（如进程 starttime）用来区分同一 ID 被复用后的新实体，可省略
+struct RateSpec {
+    static constexpr std::size_t kNoColumn = static_cast<std::size_t>(-1);
+
+    std::size_t              idColumn{kNoColumn};
+    std::size_t              generationColumn{kNoColumn};
+    std::vector<CounterDesc> counters;
+};
+
+class Schema {
+public:
+    // columns 的顺序必须与各 Col<T>::index 一致，构造时校验
+    Schema(std::string name, std::int8_t collectorType, std::vector<ColumnDesc> columns,
+           const Schema* child = nullptr, const char* childName = nullptr);
+
+    template <typename T>
+    static ColumnDesc column(const Col<T>& c) { return {c.name, column_type_of<T>::value, c.index}; }
+    static CounterDesc counter(const Col<std::uint64_t>& c, const Col<double>& rate) { return {c.index, rate.index}; }
+    static RateSpec rates(const Col<std::int64_t>& id, std::vector<CounterDesc> counters) {
+        return {id.index, RateSpec::kNoColumn, std::move(counters)};
+    }
+    static RateSpec rates(const Col<std::int64_t>& id, const Col<std::uint64_t>& generation,
+                          std::vector<CounterDesc> counters) {
+        return {id.index, generation.index, std::move(counters)};
+    }
+
+    // 声明计数器，例如
+    //   static const Schema s = Schema(...).withRates(Schema::rates(kPid, kStarttime, {...}));
+    // 列类型不符时抛出 std::invalid_argument
+    Schema&& withRates(RateSpec spec) &&;
+
+    const std::string&             name() const { return name_; }
+    std::int8_t                    collectorType() const { return collectorType_; }   // -1 表示子表
+    const std::vector<ColumnDesc>& columns() const { return columns_; }
+    const Schema*                  child() const { return child_; }
+    const char*                    childName() const { return childName_; }
+    const RateSpec*                rates() const { return rates_.counters.empty() ? nullptr : &rates_; }
+
+private:
+    std::string             name_;
+    std::int8_t             collectorType_;
+    std::vector<ColumnDesc> columns_;
+    const Schema*           child_;
+    const char*             childName_;
+    RateSpec                rates_;
+};
+
+class SampleBatch {
+public:
+    // 下标与 ColumnType 一一对应
+    using ColumnData = std::variant<std::pmr::vector<std::int64_t>,
+                                    std::pmr::vector<std::uint64_t>,
+                                    std::pmr::vector<double>,
+                                    std::pmr::vector<std::string_view>,
+                                    std::pmr::vector<std::uint8_t>>;
+
+    // 在当前线程所属周期的 TickArena（TickArena::current()）上分配，
+    // 不在采集周期内时使用批次私有的单调分配区
+    explicit SampleBatch(const Schema& schema);
+    ~SampleBatch();
+
+    const Schema& schema() const { return *schema_; }
+    std::size_t   rows() const { return rows_; }
+    bool          empty() const { return rows_ == 0; }
+
+    void reserve(std::size_t rows);
+    // 所有列追加一个默认值，返回新行的下标
+    std::size_t appendRow();
+
+    // 值的类型由列句柄决定（不参与推导），整数字面量等可直接传入
+    template <typename T>
+    void set(std::size_t row, const Col<T>& c, typename std::common_type<T>::type v) { column(c)[row] = std::move(v); }
+    void set(std::size_t row, const Col<std::string_view>& c, std::string_view v) = delete;   // 须指明字符串的归属
+
+    // 字符串拷贝到本批次的分配区，随批次一起释放
+    void setString(std::size_t row, const Col<std::string_view>& c, std::string_view v);
+    // 进程名等重复度高的字符串放入全局驻留表，只保存视图；驻留表已满时退化为 setString
+    void setInterned(std::size_t row, const Col<std::string_view>& c, std::string_view v);
+
+    template <typename T>
+    auto& column(const Col<T>& c) { return std::get<static_cast<std::size_t>(column_type_of<T>::value)>(cols_[c.index]); }
+    template <typename T>
+    const auto& column(const Col<T>& c) const { return std::get<static_cast<std::size_t>(column_type_of<T>::value)>(cols_[c.index]); }
+
+    ColumnData&       data(std::size_t col) { return cols_[col]; }
+    const ColumnData& data(std::size_t col) const { return cols_[col]; }
+
+    // 子表（例如进程下的线程）：子表的行按父行顺序连续存放，
+    // appendRow() 之后追加的子行都属于刚追加的父行
+    SampleBatch*       child() { return child_.get(); }
+    const SampleBatch* child() const { return child_.get(); }
+    std::pair<std::size_t, std::size_t> childRange(std::size_t row) const;
+
+private:
+    SampleBatch(const Schema& schema, std::shared_ptr<TickArena> arena);
+
+    std::shared_ptr<TickArena>       arena_;   // 批次存活期间 arena 不会复位
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> own_;   // 没有 arena 时使用
+    std::pmr::memory_resource*       mr_;
+    const Schema*                    schema_;
+    std::size_t                      rows_ = 0;
+    std::vector<ColumnData>          cols_;
+    std::unique_ptr<SampleBatch>     child_;
+    std::pmr::vector<std::size_t>    childBegin_;   // 每个父行第一个子行的下标
+};
+
+using SampleBatchPtr = std::shared_ptr<const SampleBatch>;
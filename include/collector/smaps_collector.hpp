@@ -0,0 +1,95 @@
+#pragma once
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LOGGER_TRACE
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <any>
+#include <array>
+#include "collector/collector_type.h"
+#include "collector/procfs_reader.hpp"
+#include "icollector.h"
+
+// 读取 /proc/<pid>/smaps_rollup，上报 PSS / USS / swap 以及匿名页与文件页的拆分。
+// PSS 按共享者均摊共享页，作业内各进程相加不会像 RSS 那样重复计算共享库与共享内存。
+// smaps_rollup 需要遍历整个地址空间，开销远大于 statm：
+// 本采集器使用独立的 freq，且 RSS 未变化的 PID 直接沿用上次结果（最长 max_age 秒）。
+namespace smaps_collector {
+
+struct smaps_info {
+    int8_t        type{int8_t(CollectorType::SmapsCollector)};
+    int           pid{};               // 作业汇总行为 0
+    std::string   name;
+
+    // 单位 KB
+    std::uint64_t rssKb{};
+    std::uint64_t pssKb{};
+    std::uint64_t pssAnonKb{};
+    std::uint64_t pssFileKb{};
+    std::uint64_t pssShmemKb{};
+    std::uint64_t ussKb{};             // Private_Clean + Private_Dirty
+    std::uint64_t swapKb{};
+    std::uint64_t swapPssKb{};
+    bool          reused{};            // RSS 未变化，本次未重新读取
+};
+
+// collect() 的结果：每个进程一行（scope=process），最后一行为作业汇总（scope=job）
+namespace cols {
+inline constexpr Col<std::string_view> kScope{0, "scope"};
+inline constexpr Col<std::int64_t>     kPid{1, "pid"};
+inline constexpr Col<std::string_view> kName{2, "name"};
+inline constexpr Col<std::uint64_t>    kRssKb{3, "rssKb"};
+inline constexpr Col<std::uint64_t>    kPssKb{4, "pssKb"};
+inline constexpr Col<std::uint64_t>    kPssAnonKb{5, "pssAnonKb"};
+inline constexpr Col<std::uint64_t>    kPssFileKb{6, "pssFileKb"};
+inline constexpr Col<std::uint64_t>    kPssShmemKb{7, "pssShmemKb"};
+inline constexpr Col<std::uint64_t>    kUssKb{8, "ussKb"};
+inline constexpr Col<std::uint64_t>    kSwapKb{9, "swapKb"};
+inline constexpr Col<std::uint64_t>    kSwapPssKb{10, "swapPssKb"};
+inline constexpr Col<bool>             kReused{11, "reused"};
+} // namespace cols
+
+const Schema& smapsSchema();
+
+class SmapsCollector : public ICollector {
+public:
+    bool init(const nlohmann::json& cfg) override;
+    CollectResult collect(const Job& job) override;
+    void deinit() noexcept override;
+    void beginTick(const TickContext& ctx) override;
+
+private:
+    bool sample(int pid, smaps_info& out);
+    static void appendRow(SampleBatch& batch, const smaps_info& info, const char* scope);
+    void sweepIdle();
+
+    static constexpr auto kIdleTimeout = std::chrono::seconds(30);
+
+    struct pid_cache {
+        std::uint64_t starttime{};
+        std::int64_t  rssPages{-1};
+        std::chrono::steady_clock::time_point lastRead{};
+        std::chrono::steady_clock::time_point lastSeen{};
+        smaps_info    info;
+    };
+
+    static constexpr std::size_t kShards = 16;
+
+    /* 按 PID 分片：读 smaps_rollup 需要遍历整个地址空间，同一周期内多个作业并行采集时只在分片内互斥 */
+    struct shard {
+        std::mutex m;
+        std::unordered_map<int, pid_cache> cache;
+        procfs::PidHandleCache handle_cache{1024 / kShards};
+    };
+    shard& shardOf(int pid) { return shards_[static_cast<unsigned>(pid) % kShards]; }
+
+    std::array<shard, kShards> shards_;
+    std::chrono::steady_clock::duration max_age_{std::chrono::seconds(60)};
+    std::chrono::steady_clock::time_point last_sweep_{};
+};
+
+} // namespace smaps_collector
@@ -0,0 +1,116 @@
+#pragma once
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LOGGER_TRACE
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <any>
+#include "collector/collector_type.h"
+#include "collector/procfs_reader.hpp"
+#include "collector/rate_engine.hpp"
+#include "icollector.h"
+
+struct nlmsghdr;
+
+// 通过 genetlink TASKSTATS 家族按进程获取二进制、定长的记账数据：
+// CPU 时间、I/O 字节数以及 proc_info 无法提供的延迟记账（cpu / blkio / swapin）。
+// 需要 CAP_NET_ADMIN；延迟记账需要内核开启 delayacct（sysctl kernel.task_delayacct=1）。
+namespace taskstats_collector {
+
+struct taskstats_info {
+    int8_t        type{int8_t(CollectorType::TaskstatsCollector)};
+    int           pid{};
+    std::string   name;
+    std::uint64_t beginTime{};          // 进程启动时间（Unix 时间，秒），区分 PID 复用；
+                                        // 按 tgid 汇总时内核不填充，取自 /proc/<pid>/stat
+
+    // CPU（微秒）
+    std::uint64_t utimeUs{};
+    std::uint64_t stimeUs{};
+    std::uint64_t nvcsw{};              // 主动上下文切换
+    std::uint64_t nivcsw{};             // 被动上下文切换
+
+    // 延迟记账（纳秒）与次数
+    std::uint64_t cpuDelayCount{};
+    std::uint64_t cpuDelayNs{};         // 等待 CPU 的时间
+    std::uint64_t blkioDelayCount{};
+    std::uint64_t blkioDelayNs{};       // 等待块设备 I/O 的时间
+    std::uint64_t swapinDelayCount{};
+    std::uint64_t swapinDelayNs{};      // 等待换入的时间
+
+    // I/O（按 tgid 汇总时内核可能不填充）
+    std::uint64_t readBytes{};
+    std::uint64_t writeBytes{};
+    std::uint64_t readChar{};
+    std::uint64_t writeChar{};
+};
+
+namespace cols {
+inline constexpr Col<std::int64_t>     kPid{0, "pid"};
+inline constexpr Col<std::string_view> kName{1, "name"};
+inline constexpr Col<std::uint64_t>    kUtimeUs{2, "utimeUs"};
+inline constexpr Col<std::uint64_t>    kStimeUs{3, "stimeUs"};
+inline constexpr Col<std::uint64_t>    kNvcsw{4, "nvcsw"};
+inline constexpr Col<std::uint64_t>    kNivcsw{5, "nivcsw"};
+inline constexpr Col<std::uint64_t>    kCpuDelayCount{6, "cpuDelayCount"};
+inline constexpr Col<std::uint64_t>    kCpuDelayNs{7, "cpuDelayNs"};
+inline constexpr Col<std::uint64_t>    kBlkioDelayCount{8, "blkioDelayCount"};
+inline constexpr Col<std::uint64_t>    kBlkioDelayNs{9, "blkioDelayNs"};
+inline constexpr Col<std::uint64_t>    kSwapinDelayCount{10, "swapinDelayCount"};
+inline constexpr Col<std::uint64_t>    kSwapinDelayNs{11, "swapinDelayNs"};
+inline constexpr Col<std::uint64_t>    kReadBytes{12, "readBytes"};
+inline constexpr Col<std::uint64_t>    kWriteBytes{13, "writeBytes"};
+inline constexpr Col<std::uint64_t>    kReadChar{14, "readChar"};
+inline constexpr Col<std::uint64_t>    kWriteChar{15, "writeChar"};
+inline constexpr Col<std::uint64_t>    kBeginTime{16, "beginTime"};
+// 由累计计数器换算的每秒速率
+inline constexpr Col<double>           kUtimeRate{17, "utimeRate"};         // 微秒/秒
+inline constexpr Col<double>           kStimeRate{18, "stimeRate"};
+inline constexpr Col<double>           kNvcswRate{19, "nvcswRate"};
+inline constexpr Col<double>           kNivcswRate{20, "nivcswRate"};
+inline constexpr Col<double>           kCpuDelayRate{21, "cpuDelayRate"};    // 纳秒/秒
+inline constexpr Col<double>           kBlkioDelayRate{22, "blkioDelayRate"};
+inline constexpr Col<double>           kReadBytesRate{23, "readBytesRate"};  // 字节/秒
+inline constexpr Col<double>           kWriteBytesRate{24, "writeBytesRate"};
+} // namespace cols
+
+const Schema& taskstatsSchema();
+
+class TaskstatsCollector : public ICollector {
+public:
+    ~TaskstatsCollector() override { deinit(); }
+
+    bool init(const nlohmann::json& cfg) override;
+    CollectResult collect(const Job& job) override;
+    std::vector<CollectResult> collectBatch(const std::vector<JobPtr>& jobs) override;
+    bool batched() const override { return true; }
+    void deinit() noexcept override;
+    void beginTick(const TickContext& ctx) override;
+
+private:
+    static constexpr std::size_t kWindow = 32;   // 批量查询时在途请求数上限
+    static constexpr auto kIdleTimeout = std::chrono::seconds(30);
+
+    bool openSocket();
+    bool resolveFamily();
+    bool sendQuery(int pid, std::uint32_t seq);
+    bool parseReply(const nlmsghdr* nh, int pid, taskstats_info& out);
+    bool query(int pid, taskstats_info& out);
+    void queryMany(const std::vector<int>& pids, std::vector<taskstats_info>& out, std::vector<char>& ok);
+    bool fillBeginTime(taskstats_info& info);
+    static void appendRow(SampleBatch& batch, const taskstats_info& info);
+
+    std::mutex    mtx_;                 // 一个 socket 上同一时刻只有一个请求
+    int           sock_{-1};
+    std::uint16_t family_{};
+    std::uint32_t seq_{};
+    bool          per_tgid_{true};      // true: 汇总整个线程组；false: 只取主线程（含 comm 与 I/O）
+    std::uint64_t boot_time_{};         // /proc/stat btime
+    long          hz_{};
+    procfs::PidHandleCache handles_{1024};   // 按 tgid 汇总时读取 stat 的 starttime
+    RateEngine    rates_;
+};
+
+} // namespace taskstats_collector
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// 采集周期内的单调分配区：一个周期所有作业的采集结果（SampleBatch 的列与字符串）
+// 都从同一个 TickArena 分配，释放只是移动指针；所有写入器处理完本周期的批次后
+// （最后一个 SampleBatch 析构），整块区域一次性复位并回到池中供下个周期使用。
+class TickArena {
+public:
+    TickArena();
+    ~TickArena();
+
+    TickArena(const TickArena&)            = delete;
+    TickArena& operator=(const TickArena&) = delete;
+
+    // 当前线程应使用的分配器；同一周期内多个工作线程并发采集，按线程分片，各片独立加锁
+    std::pmr::memory_resource* resource();
+
+    // 复位所有分片；上个周期用量超过初始缓冲区时，下次按用量扩大初始缓冲区
+    void reset();
+
+    // 采集线程当前所属的周期；SampleBatch 构造时自动从中分配，为空时使用普通堆
+    static const std::shared_ptr<TickArena>& current();
+
+    // 在作用域内把 arena 设为当前线程的 current()
+    class Scope {
+    public:
+        explicit Scope(std::shared_ptr<TickArena> arena);
+        ~Scope();
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        std::shared_ptr<TickArena> prev_;
+    };
+
+private:
+    class Shard : public std::pmr::memory_resource {
+    public:
+        Shard();
+        void reset();
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t align) override;
+        void  do_deallocate(void*, std::size_t, std::size_t) override {}   // 单调分配，整体复位
+        bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        static constexpr std::size_t kInitialSize = 64 * 1024;
+        static constexpr std::size_t kMaxInitialSize = 16 * 1024 * 1024;
+
+        std::mutex                                        m_;
+        std::unique_ptr<std::byte[]>                      initial_;
+        std::size_t                                       initialSize_ = kInitialSize;
+        std::size_t                                       used_ = 0;
+        std::optional<std::pmr::monotonic_buffer_resource> mono_;
+    };
+
+    static constexpr std::size_t kShards = 8;
+    std::array<Shard, kShards> shards_;
+};
+
+// 空闲 TickArena 的池：acquire() 返回的 shared_ptr 最后一个引用释放时，arena 复位后回池
+class TickArenaPool {
+public:
+    static TickArenaPool& instance();
+    std::shared_ptr<TickArena> acquire();
+
+private:
+    TickArenaPool() = default;
+    void recycle(TickArena* arena);
+
+    static constexpr std::size_t kMaxIdle = 16;
+    std::mutex                              m_;
+    std::vector<std::unique_ptr<TickArena>> idle_;
+};
+
+// 进程名等重复度很高的短字符串的驻留表：返回的 string_view 在进程生命周期内有效。
+// 条目数达到上限后不再驻留，由调用方改为拷贝到 arena。
+// 表在进程退出时有意不释放（instance() 用 new 创建）：写入器线程在静态析构期间可能仍持有视图，
+// 内存上限为 kMaxEntries 个名字，对 comm（至多 15 字节）约几 MB
+class NameInterner {
+public:
+    static NameInterner& instance();
+    // 成功时返回驻留的视图；表已满时返回 std::nullopt
+    std::optional<std::string_view> intern(std::string_view s);
+
+private:
+    NameInterner() = default;
+
+    static constexpr std::size_t kMaxEntries = 1 << 16;
+    std::shared_mutex                    m_;
+    /* 查找直接用 string_view，不为每次命中构造 std::string；
+       视图指向 storage_ 中的字符串，deque 追加元素不会移动已有元素 */
+    std::unordered_set<std::string_view> names_;
+    std::deque<std::string>              storage_;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+// 批量采集的周期预算：把本周期到期的作业按块交给批量采集器，
+// 超过截止时间后不再开始新的块，剩余作业留到下个周期优先采集。
+// 每周期至少执行第一块，保证最久未采集的作业总能推进
+namespace tick_budget {
+
+/* 依次调用 run(begin, end) 处理 [0, n) 中至多 chunk 个一块的区间；
+   bounded 为 false 时不看截止时间。返回已处理的个数，[返回值, n) 本周期未处理 */
+template <typename Run>
+std::size_t runChunks(std::size_t n, std::size_t chunk, bool bounded,
+                      std::chrono::steady_clock::time_point deadline, Run&& run) {
+    chunk = std::max<std::size_t>(chunk, 1);
+    std::size_t done = 0;
+    while (done < n) {
+        if (bounded && done > 0 && std::chrono::steady_clock::now() > deadline) break;
+        std::size_t end = std::min(n, done + chunk);
+        run(done, end);
+        done = end;
+    }
+    return done;
+}
+
+} // namespace tick_budget
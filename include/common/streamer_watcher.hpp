@@ -4,24 +4,41 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <sys/types.h>
 
 class StreamWatcher {
 public:
     // 统一回调签名：buf 为本次可读到的数据，len 为数据长度
     using Callback = std::function<void(const char* buf, std::size_t len)>;
+    // 请求-应答式回调：返回值非空时原样发回给对端（仅 UNIX 类型有回写通道）
+    using RequestCallback = std::function<std::string(const char* buf, std::size_t len)>;
 
     enum class Type {
         TCP,      // 监听某个 TCP 端口，有连接到达后监视该连接的 socket
         FIFO,     // 监听 Linux 管道（mkfifo）
-        FILE      // 监视一个普通文件，检测追加内容（inotify）
+        FILE,     // 监视一个普通文件，检测追加内容（inotify）
+        UNIX      // 监听 Unix 域 SOCK_SEQPACKET socket，每个数据包是一条完整请求，可回写应答
+    };
+
+    // 回调收到的数据如何分帧
+    enum class Framing {
+        Raw,      // 每次唤醒读到的全部字节原样交给回调
+        Line      // 以 '\n' 分隔消息：回调只收到完整的若干行，残缺的尾部留到下次拼接；
+                  // 写端关闭（EOF）时剩余部分作为最后一条消息交出
     };
 
     struct Config {
         Type type;
-        std::string path;   // 对于 FIFO/FILE 是文件路径；对于 TCP 是 "host:port"
+        std::string path;   // 对于 FIFO/FILE/UNIX 是文件路径；对于 TCP 是 "host:port"
+        Framing framing{Framing::Raw};
+        // 仅 UNIX：socket 文件的权限位，0 表示按进程 umask 创建
+        unsigned mode{0};
+        // 仅 UNIX：按 SO_PEERCRED 取得的对端 uid / gid 决定是否接受连接，为空时不检查
+        std::function<bool(uid_t uid, gid_t gid)> authorize;
     };
 
     StreamWatcher(const Config& cfg, Callback cb);
+    StreamWatcher(const Config& cfg, RequestCallback cb);
     ~StreamWatcher();
 
     void start();   // 启动事件循环（内部线程）
@@ -5,14 +5,21 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
-#include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <string>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
+#include "common/work_stealing_executor.hpp"
+
+// 定时器线程只负责计时，到期的任务交给工作窃取执行器运行。
+// 计时采用 1ms 精度的四级分层时间轮（每级 256 槽，覆盖约 49 天）：
+// 注册与取消均为 O(1)，取消时立即从槽中摘除；每个任务只保存一份 std::function，派发时只增加引用计数。
+// 定时器节点放在可复用的节点池中，任务 id 由池下标与代号组成，取消时无需查表。
 class TimerScheduler {
 public:
     using Task      = std::function<void()>;
@@ -20,21 +27,25 @@ public:
     using TimePoint = std::chrono::time_point<Clock>;
     using Duration  = std::chrono::milliseconds;
 
-    struct TimerTask {
-        TimePoint nextRun;
-        Duration  interval;
-        Task      task;
-        bool      repeat;
-        size_t    id;
+    // 对齐定时器的一次触发
+    struct Tick {
+        std::chrono::system_clock::time_point scheduled;   // 本次对应的整点（墙上时间）
+        uint64_t                              missed = 0;  // 在此之前被跳过/合并的整点数
+    };
+    using TickTask = std::function<void(const Tick&)>;
 
-        bool operator<(const TimerTask& other) const {
-            return nextRun > other.nextRun;
-        }
+    // 上一次还没执行完、或调度被推迟越过了整点时的处理方式
+    enum class MissedTickPolicy {
+        Skip,       // 丢弃错过的整点，只执行最新的一个；上一次仍在执行时本次直接丢弃
+        Coalesce,   // 错过的整点合并为一次（missed 记录合并数），执行中时最多挂起一次
+        CatchUp,    // 每个错过的整点都补执行（挂起数有上限）
     };
+    static bool parsePolicy(const std::string& name, MissedTickPolicy& out);
 
-    explicit TimerScheduler(size_t numWorkers = 1);
+    explicit TimerScheduler(WorkStealingExecutor& executor = WorkStealingExecutor::instance());
     ~TimerScheduler();
 
+    // 停止计时并等待已派发的任务执行完
     void shutdown();
 
     // 注册单次定时任务
@@ -43,28 +54,82 @@ public:
     // 注册重复定时任务
     size_t registerRepeatingTimer(Duration interval, Task task);
 
+    // 注册按墙上时间整点对齐的固定频率任务：在 interval 的整数倍（自 Unix 纪元起）触发，
+    // 下次触发时间由整点推算而非“本次结束 + interval”，慢周期不会推迟后续周期；
+    // 同一 interval 的定时器总是落在同一组时间戳上。同一定时器的任务不会并发执行
+    size_t registerAlignedTimer(Duration interval, MissedTickPolicy policy, TickTask task);
+
     // 取消任务
     bool cancelTimer(size_t id);
 
 private:
+    friend struct TimerWheelProbe;   // test/timer_wheel_probe.hpp：单元测试与基准不经计时线程直接驱动时间轮
+
+    static constexpr int      kLevels   = 4;
+    static constexpr int      kSlotBits = 8;
+    static constexpr uint64_t kSlots    = uint64_t(1) << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+    static constexpr size_t   kMaxCatchUp = 64;   // CatchUp 策略下最多挂起的整点数
+
+    // 对齐定时器的状态，执行器上的任务与定时器节点共享
+    struct AlignedState {
+        MissedTickPolicy                      policy;
+        TickTask                              task;
+        std::chrono::system_clock::time_point nextWall;   // 下一个整点
+        std::mutex                            m;
+        std::deque<Tick>                      pending;    // 待执行的整点
+        bool                                  running = false;
+        bool                                  cancelled = false;   // cancelTimer() 后驱动任务不再执行挂起的整点
+        uint64_t                              dropped = 0;   // Skip 策略下因执行中而丢弃的整点数
+    };
+
+    // 槽内用侵入式双向链表串起，pprev 指向前驱的 next（或槽头），摘除无需知道所在槽
+    struct TimerNode {
+        size_t                      id;         // 高 32 位代号，低 32 位池下标；0 表示空闲
+        uint64_t                    expire;     // 到期 tick（毫秒）
+        Duration                    interval;
+        bool                        repeat;
+        std::shared_ptr<const Task> task;       // 对齐定时器为执行 pending 的驱动任务
+        std::shared_ptr<AlignedState> aligned;  // 普通定时器为空
+        TimerNode*                  next  = nullptr;
+        TimerNode**                 pprev = nullptr;
+    };
+
     size_t addTask(Task task, Duration interval, bool repeat);
+    TimerNode* allocNode();
+    TimerNode* findNode(size_t id) const;
+    bool fireAligned(TimerNode* node, uint64_t tick);
+    void releaseNode(TimerNode* node);
+
+    void link(TimerNode* node);          // 按到期 tick 放入对应层级的槽
+    static void unlink(TimerNode* node);
+    void cascade(int level, uint64_t index);
+    void advance(uint64_t target);       // 推进到 target，把到期任务收集到 due
+    uint64_t nextWakeTick() const;
+    uint64_t toTick(TimePoint tp) const;
 
     void schedulerLoop();
-    void workerLoop();
+    void dispatch(const std::shared_ptr<const Task>& task);
 
-    std::vector<std::thread> workers;
+    WorkStealingExecutor&    executor;
     std::thread              schedulerThread;
 
-    std::priority_queue<TimerTask>         tasks;
-    std::unordered_map<size_t, TimerTask>  taskMap;
-
-    std::queue<Task> taskQueue;
+    TimerNode*                                     wheel[kLevels][kSlots] = {};
+    TimerNode*                                     overflow = nullptr;   // 超出四级范围
+    std::vector<std::unique_ptr<TimerNode>>        nodePool;
+    std::vector<uint32_t>                          freeNodes;
+    size_t                                         activeCount = 0;
+    std::vector<std::shared_ptr<const Task>>       due;
+    TimePoint                                      origin;
+    uint64_t                                       currentTick = 0;
 
     std::mutex              mtx;
-    std::mutex              queueMtx;
     std::condition_variable cv;
-    std::condition_variable schedulerCv;
+
+    std::mutex              inflightMtx;
+    std::condition_variable inflightCv;
+    size_t                  inflight = 0;   // 已派发、尚未执行完的任务数
 
     std::atomic<bool>  stop;
-    std::atomic<size_t> nextId;
+    uint32_t           generation = 0;
 };
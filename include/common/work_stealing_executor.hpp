@@ -0,0 +1,68 @@
+#pragma once
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LOGGER_TRACE
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 进程内共享的工作窃取执行器：采集周期与按作业的并行采集在 instance() 上执行，
+// 写入器刷新（可能阻塞在网络 I/O 上直到 write_timeout）在单独的 writerInstance() 上执行，
+// 卡住的写入端不会占用采集线程。
+// 每个工作线程有自己的双端队列：自己从尾部取（LIFO，缓存友好），空闲线程从别人头部窃取。
+// 只有在有线程休眠时提交方才会去碰唤醒用的锁与条件变量。
+class WorkStealingExecutor {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingExecutor(std::size_t numWorkers);
+    ~WorkStealingExecutor();
+
+    WorkStealingExecutor(const WorkStealingExecutor&)            = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    // 线程数取 lens_config.max_collector_threads
+    static WorkStealingExecutor& instance();
+
+    // 写入器刷新专用，线程数取 writers_config.flush_threads（默认 1）
+    static WorkStealingExecutor& writerInstance();
+
+    // 工作线程内提交的任务进入本线程队列，外部提交轮流分配；已关闭时就地执行
+    void submit(Task task);
+
+    // 对 [0, n) 中的每个下标调用一次 fn，全部完成后返回。
+    // 调用者自己也领取下标执行，因此在工作线程内调用（嵌套）也不会死锁
+    void parallelFor(std::size_t n, const std::function<void(std::size_t)>& fn);
+
+    // 执行完队列中剩余的任务后回收线程
+    void shutdown();
+
+    std::size_t size() const { return queues_.size(); }
+
+private:
+    struct WorkQueue {
+        std::mutex       m;
+        std::deque<Task> q;
+    };
+
+    bool popLocal(std::size_t self, Task& out);
+    bool steal(std::size_t self, Task& out);
+    void workerLoop(std::size_t self);
+    void run(Task& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread>                threads_;
+
+    std::atomic<std::size_t> pending_{0};    // 已入队、尚未被取走的任务数
+    std::atomic<std::size_t> sleepers_{0};   // 正在休眠的工作线程数
+    std::atomic<std::size_t> next_{0};       // 外部提交的轮转下标
+    std::atomic<bool>        stop_{false};
+
+    std::mutex              parkMtx_;
+    std::condition_variable parkCv_;
+};
@@ -21,9 +21,10 @@
 // 前向声明 fmt 为头文件减负；cpp 里再真正 include <fmt/core.h>
 namespace fmt {}  // 占位，无实质依赖
 
+// 持有作业快照的引用：写入器异步刷新时采集线程上的 JobPtr 早已释放，快照本身不可变
 using write_data = std::tuple<std::string,
-                              const Job&,
-                              const std::any,
+                              JobPtr,
+                              CollectResult,
                               std::chrono::system_clock::time_point>;
 
 class base_writer
@@ -32,26 +33,11 @@ public:
     explicit base_writer(std::string name, std::string type, std::string config_name);
     virtual ~base_writer();
 
-    void shutdown() {
-        {
-            std::lock_guard lg(mtx_);
-            stop_ = true;
-            need_flush_ = false;
-        }
-        
-        cv_.notify_one();
-        spdlog::info("base_writer: shutting down...");
-        if (flush_thread_.joinable()){
-            spdlog::info("base_writer: waiting for flush worker to finish...");
-            flush_thread_.join();
-        }
-        flush_buffer(*front_);
-        spdlog::info("base_writer: shutdown complete for writer '{}'", name_);
-    }
+    void shutdown();
 
     void on_finish(std::string collect_name,
-                   const Job& job,
-                   const std::any data,
+                   JobPtr job,
+                   CollectResult data,
                    std::chrono::system_clock::time_point ts);
 
     OnFinish get_onFinishCallback();
@@ -67,18 +53,18 @@ private:
     struct Buffer;
 
     
-    void flush_worker();
+    void flush_task();
     void flush_buffer(Buffer& buf);
     void trigger_async_flush();
+    void wait_flush_idle();
     
     const std::size_t buf_capacity_;
     std::unique_ptr<Buffer> front_;
     std::unique_ptr<Buffer> back_;
 
-    std::mutex mtx_;
-    std::condition_variable cv_;
-    std::thread flush_thread_;
+    std::mutex mtx_;                    // 保护 front_ 与下面的状态
+    std::condition_variable cv_;        // 刷新任务结束时通知
     bool stop_ = false;
-    bool need_flush_ = false;
+    bool flush_scheduled_ = false;      // 写入器执行器上已有一个刷新任务（排队或执行中）
 
 };
\ No newline at end of file
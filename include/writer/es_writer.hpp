@@ -5,6 +5,7 @@
 #include "writer/base_writer.hpp"
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
+#include <unordered_map>
 
 class ESWriter : public base_writer
 {
@@ -30,10 +31,11 @@ public:
 private:
     bool post_bulk(const std::string& bulk_body);
     bool test_server();
-    std::string try_get_index_name(const write_data& w);
-    bool try_parse_data(const std::string& collector_name, const std::any& data, nlohmann::json& out);
+    std::string try_get_index_name(const write_data& w) const;
+    bool try_parse_data(const std::string& collector_name, const CollectResult& data, nlohmann::json& out);
     int write_timeout;
     options opt_;
+    std::unordered_map<std::string, std::string> index_names_;   // collector_name -> index_name
     std::vector<write_data> local_buf_;   // 子类私有缓冲
     std::mutex local_mtx_;                // 保护 local_buf_
     CURL* curl_ = nullptr;
@@ -0,0 +1,169 @@
+/* joblens_ctl.c —— 作业控制协议的 C 客户端，见 joblens_ctl.h */
+#include "client/joblens_ctl.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct jl_client {
+    int      fd;
+    uint32_t seq;
+    char     buf[JL_MAX_PACKET];
+};
+
+jl_client* jl_connect(const char* path, int timeout_ms) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    jl_client* c = malloc(sizeof(*c));
+    if (!c) return NULL;
+    c->seq = 0;
+    c->fd  = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (c->fd < 0) goto fail;
+    if (timeout_ms > 0) {
+        struct timeval tv = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+        setsockopt(c->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(c->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    }
+    if (connect(c->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) goto fail;
+    return c;
+
+fail:;
+    int saved = errno;
+    if (c->fd >= 0) close(c->fd);
+    free(c);
+    errno = saved;
+    return NULL;
+}
+
+void jl_close(jl_client* c) {
+    if (!c) return;
+    if (c->fd >= 0) close(c->fd);
+    free(c);
+}
+
+/* 把一条操作追加到 c->buf 的 off 处，空间不足时返回 0 */
+static size_t encode(jl_client* c, size_t off, const struct jl_job_op* op, uint32_t seq) {
+    struct jl_rec_hdr h;
+    memset(&h, 0, sizeof(h));
+    h.magic   = JL_MAGIC;
+    h.version = JL_VERSION;
+    h.op      = op->op;
+    h.seq     = seq;
+    h.job_id  = op->job_id;
+    h.flags   = op->flags;
+    if (op->flags & JL_F_PIDS) h.n_pids = op->n_pids;
+    if (op->flags & JL_F_LENS)
+        for (uint32_t i = 0; i < op->n_lens; ++i) h.lens_bytes += (uint32_t)strlen(op->lens[i]) + 1;
+    h.freq        = op->freq;
+    h.create_time = op->create_time;
+
+    size_t len = sizeof(h) + (size_t)h.n_pids * sizeof(int32_t) + h.lens_bytes;
+    if (off + len > sizeof(c->buf)) return 0;
+    h.len = (uint32_t)len;
+
+    char* p = c->buf + off;
+    memcpy(p, &h, sizeof(h));
+    p += sizeof(h);
+    if (h.n_pids) {
+        memcpy(p, op->pids, (size_t)h.n_pids * sizeof(int32_t));
+        p += (size_t)h.n_pids * sizeof(int32_t);
+    }
+    if (op->flags & JL_F_LENS) {
+        for (uint32_t i = 0; i < op->n_lens; ++i) {
+            size_t n = strlen(op->lens[i]) + 1;
+            memcpy(p, op->lens[i], n);
+            p += n;
+        }
+    }
+    return len;
+}
+
+int jl_submit(jl_client* c, const struct jl_job_op* ops, size_t n, int32_t* status) {
+    if (n == 0) return 0;
+    if (n > UINT16_MAX) return -EMSGSIZE;
+
+    uint32_t first = c->seq;
+    size_t off = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t len = encode(c, off, &ops[i], first + (uint32_t)i);
+        if (len == 0) return -EMSGSIZE;
+        off += len;
+    }
+    c->seq += (uint32_t)n;
+
+    if (c->fd < 0) return -ENOTCONN;
+    if (send(c->fd, c->buf, off, MSG_NOSIGNAL) < 0) return -errno;
+
+    struct jl_ack_hdr ah;
+    for (;;) {
+        ssize_t got = recv(c->fd, c->buf, sizeof(c->buf), 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            /* 超时后应答可能迟到，继续用这条连接会读到错位的应答：直接断开 */
+            close(c->fd);
+            c->fd = -1;
+            return -ETIMEDOUT;
+        }
+        if (got < 0) return -errno;
+        if (got == 0) return -ECONNRESET;
+
+        if ((size_t)got < sizeof(ah)) return -EPROTO;
+        memcpy(&ah, c->buf, sizeof(ah));
+        if (ah.magic != JL_MAGIC || (size_t)got < sizeof(ah) + (size_t)ah.count * sizeof(struct jl_ack))
+            return -EPROTO;
+        if (ah.count == 0) return -EPROTO;
+
+        /* 应答里第一条记录不属于本次请求：是更早请求的迟到应答，丢弃后继续等 */
+        struct jl_ack a;
+        memcpy(&a, c->buf + sizeof(ah), sizeof(a));
+        if (a.seq - first < n) break;
+    }
+
+    /* 记录头损坏时服务端只应答到出错的那条，其余按协议错误处理 */
+    for (size_t i = 0; i < n; ++i) status[i] = JL_E_PROTO;
+    for (uint16_t i = 0; i < ah.count; ++i) {
+        struct jl_ack a;
+        memcpy(&a, c->buf + sizeof(ah) + (size_t)i * sizeof(a), sizeof(a));
+        uint32_t idx = a.seq - first;
+        if (idx < n) status[idx] = a.status;
+    }
+    return 0;
+}
+
+int jl_add_job(jl_client* c, int32_t job_id, const int32_t* pids, uint32_t n_pids,
+               const char* const* lens, uint32_t n_lens, double freq) {
+    struct jl_job_op op;
+    memset(&op, 0, sizeof(op));
+    op.op     = JL_OP_ADD;
+    op.flags  = JL_F_PIDS | JL_F_LENS | (freq > 0 ? JL_F_FREQ : 0);
+    op.job_id = job_id;
+    op.pids   = pids;
+    op.n_pids = n_pids;
+    op.lens   = lens;
+    op.n_lens = n_lens;
+    op.freq   = freq;
+    int32_t st;
+    int rc = jl_submit(c, &op, 1, &st);
+    return rc < 0 ? rc : st;
+}
+
+int jl_remove_job(jl_client* c, int32_t job_id) {
+    struct jl_job_op op;
+    memset(&op, 0, sizeof(op));
+    op.op     = JL_OP_REMOVE;
+    op.job_id = job_id;
+    int32_t st;
+    int rc = jl_submit(c, &op, 1, &st);
+    return rc < 0 ? rc : st;
+}
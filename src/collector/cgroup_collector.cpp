@@ -0,0 +1,408 @@
+#include "collector/cgroup_collector.hpp"
+#include "collector/collector_registry.hpp"
+#include "collector/procfs_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <spdlog/spdlog.h>
+
+namespace cgroup_collector {
+
+namespace {
+
+const char* const kFileNames[] = {"cpu.stat", "memory.current", "memory.stat", "io.stat", "memory.events"};
+
+/* 读取 "key value" 形式的一行；找不到时保持原值 */
+void field(const char* buf, const char* end, const char* key, std::uint64_t& v) {
+    const char* p = procfs::find_key(buf, end, key, std::strlen(key));
+    if (p) procfs::scan_u64(p, end, v);
+}
+
+/* 从 /proc/<pid>/cgroup 中取 v2 层级（"0::"）的路径 */
+bool cgroupOf(int pid, std::string& out) {
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/%d/cgroup", pid);
+    char* buf = procfs::thread_buffer();
+    ssize_t n = procfs::read_file(path, buf, procfs::kReadBufSize);
+    if (n <= 0) return false;
+    const char* end = buf + n;
+    const char* p = procfs::find_key(buf, end, "0::", 3);
+    if (!p) return false;
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    out.assign(p, eol ? eol : end);
+    return !out.empty();
+}
+
+/* 两个 cgroup 路径的最近公共祖先 */
+std::string commonAncestor(const std::string& a, const std::string& b) {
+    std::size_t i = 0, last = 0;
+    while (i < a.size() && i < b.size() && a[i] == b[i]) {
+        if (a[i] == '/') last = i;
+        ++i;
+    }
+    if ((i == a.size() || a[i] == '/') && (i == b.size() || b[i] == '/')) last = i;
+    return last == 0 ? std::string("/") : a.substr(0, last);
+}
+
+void parseCpuStat(const char* buf, std::size_t len, cgroup_info& out) {
+    const char* end = buf + len;
+    field(buf, end, "usage_usec ", out.cpuUsageUs);
+    field(buf, end, "user_usec ", out.cpuUserUs);
+    field(buf, end, "system_usec ", out.cpuSystemUs);
+    field(buf, end, "nr_periods ", out.nrPeriods);
+    field(buf, end, "nr_throttled ", out.nrThrottled);
+    field(buf, end, "throttled_usec ", out.throttledUs);
+}
+
+void parseMemStat(const char* buf, std::size_t len, cgroup_info& out) {
+    const char* end = buf + len;
+    field(buf, end, "anon ", out.memAnon);
+    field(buf, end, "file ", out.memFile);
+    field(buf, end, "kernel ", out.memKernel);      // 5.18+
+    field(buf, end, "shmem ", out.memShmem);
+    field(buf, end, "sock ", out.memSock);
+    field(buf, end, "pgfault ", out.pgfault);
+    field(buf, end, "pgmajfault ", out.pgmajfault);
+}
+
+void parseMemEvents(const char* buf, std::size_t len, cgroup_info& out) {
+    const char* end = buf + len;
+    field(buf, end, "low ", out.memEventsLow);
+    field(buf, end, "high ", out.memEventsHigh);
+    field(buf, end, "max ", out.memEventsMax);
+    field(buf, end, "oom ", out.memEventsOom);
+    field(buf, end, "oom_kill ", out.memEventsOomKill);
+}
+
+/* io.stat 每行一个设备："MAJ:MIN rbytes=.. wbytes=.. rios=.. wios=.. dbytes=.. dios=.." */
+void parseIoStat(const char* buf, std::size_t len, cgroup_info& out) {
+    const char* p = buf;
+    const char* end = buf + len;
+    while (p < end) {
+        const char* tok = p;
+        while (p < end && *p != ' ' && *p != '\n') ++p;
+        const char* eq = static_cast<const char*>(std::memchr(tok, '=', static_cast<std::size_t>(p - tok)));
+        if (eq) {
+            const char* v = eq + 1;
+            std::uint64_t val = 0;
+            if (procfs::scan_u64(v, p, val)) {
+                std::size_t klen = static_cast<std::size_t>(eq - tok);
+                auto is = [&](const char* k) { return std::strlen(k) == klen && std::memcmp(tok, k, klen) == 0; };
+                if (is("rbytes"))      out.ioReadBytes  += val;
+                else if (is("wbytes")) out.ioWriteBytes += val;
+                else if (is("rios"))   out.ioReadOps    += val;
+                else if (is("wios"))   out.ioWriteOps   += val;
+            }
+        }
+        if (p < end) ++p;
+    }
+}
+
+/* 优先纯 v2（/sys/fs/cgroup），其次混合模式下的 unified 层级 */
+std::string detectRoot() {
+    for (const char* root : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}) {
+        std::string probe = std::string(root) + "/cgroup.controllers";
+        if (::access(probe.c_str(), R_OK) == 0) return root;
+    }
+    return {};
+}
+
+} // namespace
+
+/* ---------- job_cgroup ---------- */
+
+CgroupCollector::job_cgroup& CgroupCollector::job_cgroup::operator=(job_cgroup&& o) noexcept {
+    if (this != &o) {
+        close();
+        path      = std::move(o.path);
+        anchorPid = o.anchorPid;
+        dirFd     = std::exchange(o.dirFd, -1);
+        ino       = o.ino;
+        for (int i = 0; i < kFileCount; ++i) fds[i] = std::exchange(o.fds[i], -1);
+        resolved  = o.resolved;
+        lastSeen  = o.lastSeen;
+    }
+    return *this;
+}
+
+void CgroupCollector::job_cgroup::close() noexcept {
+    for (int& fd : fds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    if (dirFd >= 0) ::close(dirFd);
+    dirFd = -1;
+}
+
+/* ---------- CgroupCollector ---------- */
+
+const Schema& cgroupSchema() {
+    using namespace cols;
+    static const Schema schema = Schema("cgroup", int8_t(CollectorType::CgroupCollector), {
+        Schema::column(kJobId), Schema::column(kPath), Schema::column(kCpuUsageUs),
+        Schema::column(kCpuUserUs), Schema::column(kCpuSystemUs), Schema::column(kNrPeriods),
+        Schema::column(kNrThrottled), Schema::column(kThrottledUs), Schema::column(cols::kMemCurrent),
+        Schema::column(kMemAnon), Schema::column(kMemFile), Schema::column(kMemKernel),
+        Schema::column(kMemShmem), Schema::column(kMemSock), Schema::column(kPgfault),
+        Schema::column(kPgmajfault), Schema::column(kIoReadBytes), Schema::column(kIoWriteBytes),
+        Schema::column(kIoReadOps), Schema::column(kIoWriteOps), Schema::column(kMemEventsLow),
+        Schema::column(kMemEventsHigh), Schema::column(kMemEventsMax), Schema::column(kMemEventsOom),
+        Schema::column(kMemEventsOomKill), Schema::column(kCpuUsageRate), Schema::column(kThrottledRate),
+        Schema::column(kPgmajfaultRate), Schema::column(kIoReadBytesRate), Schema::column(kIoWriteBytesRate),
+        Schema::column(kIoReadOpsRate), Schema::column(kIoWriteOpsRate), Schema::column(kCgroupIno),
+    }).withRates(Schema::rates(kJobId, kCgroupIno, {
+        Schema::counter(kCpuUsageUs, kCpuUsageRate),       Schema::counter(kThrottledUs, kThrottledRate),
+        Schema::counter(kPgmajfault, kPgmajfaultRate),     Schema::counter(kIoReadBytes, kIoReadBytesRate),
+        Schema::counter(kIoWriteBytes, kIoWriteBytesRate), Schema::counter(kIoReadOps, kIoReadOpsRate),
+        Schema::counter(kIoWriteOps, kIoWriteOpsRate),
+    }));
+    return schema;
+}
+
+void CgroupCollector::appendRow(SampleBatch& batch, const cgroup_info& info) {
+    using namespace cols;
+    std::size_t r = batch.appendRow();
+    batch.set(r, kJobId, info.jobId);
+    batch.setString(r, kPath, info.path);
+    batch.set(r, kCpuUsageUs, info.cpuUsageUs);
+    batch.set(r, kCpuUserUs, info.cpuUserUs);
+    batch.set(r, kCpuSystemUs, info.cpuSystemUs);
+    batch.set(r, kNrPeriods, info.nrPeriods);
+    batch.set(r, kNrThrottled, info.nrThrottled);
+    batch.set(r, kThrottledUs, info.throttledUs);
+    batch.set(r, cols::kMemCurrent, info.memCurrent);
+    batch.set(r, kMemAnon, info.memAnon);
+    batch.set(r, kMemFile, info.memFile);
+    batch.set(r, kMemKernel, info.memKernel);
+    batch.set(r, kMemShmem, info.memShmem);
+    batch.set(r, kMemSock, info.memSock);
+    batch.set(r, kPgfault, info.pgfault);
+    batch.set(r, kPgmajfault, info.pgmajfault);
+    batch.set(r, kIoReadBytes, info.ioReadBytes);
+    batch.set(r, kIoWriteBytes, info.ioWriteBytes);
+    batch.set(r, kIoReadOps, info.ioReadOps);
+    batch.set(r, kIoWriteOps, info.ioWriteOps);
+    batch.set(r, kMemEventsLow, info.memEventsLow);
+    batch.set(r, kMemEventsHigh, info.memEventsHigh);
+    batch.set(r, kMemEventsMax, info.memEventsMax);
+    batch.set(r, kMemEventsOom, info.memEventsOom);
+    batch.set(r, kMemEventsOomKill, info.memEventsOomKill);
+    batch.set(r, kCgroupIno, info.ino);
+}
+
+bool CgroupCollector::resolve(const Job& job, job_cgroup& cg) {
+    /* 失败结果同样记下解析时间，resolve_interval_ 内不再重试 */
+    cg.resolved = std::chrono::steady_clock::now();
+    std::string common, path;
+    std::vector<std::string> paths;
+    int anchor = -1;
+    for (int pid : job.JobPIDs) {
+        if (pid <= 0 || !cgroupOf(pid, path)) continue;
+        if (anchor < 0) {
+            anchor = pid;
+            common = path;
+        } else {
+            common = commonAncestor(common, path);
+        }
+        paths.push_back(std::move(path));
+    }
+    if (anchor < 0) {
+        cg.close();
+        return false;
+    }
+    /* 公共祖先本身是否为某个作业 PID 所在的 cgroup */
+    bool exact = std::find(paths.begin(), paths.end(), common) != paths.end();
+    if (common == "/" && !allow_root_) {
+        spdlog::debug("CgroupCollector: job {} lives in the root cgroup, skipped", job.JobID);
+        cg.close();
+        return false;
+    }
+    if (!exact && !allow_ancestor_) {
+        /* 作业的进程分散在多个 cgroup（例如跨了多个 service），公共祖先会把无关进程也算进来 */
+        spdlog::warn("CgroupCollector: job {} spans several cgroups under {}, skipped (set allow_ancestor to report it)",
+                     job.JobID, common);
+        cg.close();
+        return false;
+    }
+
+    cg.anchorPid = anchor;
+    std::string full = root_ + common;
+    struct stat st{};
+    /* 路径与 inode 均未变化时保留已打开的 fd；同名 cgroup 被删除重建后 inode 不同，需要重新打开 */
+    if (cg.dirFd >= 0 && cg.path == common && ::stat(full.c_str(), &st) == 0 &&
+        static_cast<std::uint64_t>(st.st_ino) == cg.ino)
+        return true;
+
+    cg.close();
+    cg.dirFd = ::open(full.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (cg.dirFd < 0) {
+        spdlog::warn("CgroupCollector: open {} failed: {}", full, strerror(errno));
+        return false;
+    }
+    cg.ino = ::fstat(cg.dirFd, &st) == 0 ? static_cast<std::uint64_t>(st.st_ino) : 0;
+    cg.path = std::move(common);
+    spdlog::info("CgroupCollector: job {} -> cgroup {}", job.JobID, cg.path);
+    return true;
+}
+
+ssize_t CgroupCollector::readFile(job_cgroup& cg, CgroupFile f, char* buf, std::size_t cap) {
+    constexpr int kUnavailable = -2;   // 控制器未启用或无权限，不再尝试
+    int& fd = cg.fds[f];
+    if (fd == kUnavailable) return -1;
+    if (fd < 0) {
+        fd = ::openat(cg.dirFd, kFileNames[f], O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (procfs::open_failed_for_good(errno)) fd = kUnavailable;
+            return -1;
+        }
+    }
+    return procfs::pread_all(fd, buf, cap);
+}
+
+void CgroupCollector::sweepIdle() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_sweep_ < kIdleTimeout) return;
+    last_sweep_ = now;
+    rates_.sweep(kIdleTimeout);
+    for (auto it = jobs_.begin(); it != jobs_.end();) {
+        if (now - it->second.lastSeen > kIdleTimeout) it = jobs_.erase(it);
+        else ++it;
+    }
+}
+
+void CgroupCollector::beginTick(const TickContext&) {
+    std::lock_guard lg(mtx_);
+    sweepIdle();
+}
+
+bool CgroupCollector::init(const nlohmann::json& cfg) {
+    spdlog::info("CgroupCollector init with config: {}", cfg.dump());
+    std::lock_guard lg(mtx_);
+    try {
+        if (cfg.contains("cgroup_root"))
+            root_ = cfg["cgroup_root"].get<std::string>();
+        if (cfg.contains("allow_root"))
+            allow_root_ = cfg["allow_root"].get<std::string>() == "true";
+        if (cfg.contains("allow_ancestor"))
+            allow_ancestor_ = cfg["allow_ancestor"].get<std::string>() == "true";
+        if (cfg.contains("resolve_interval"))
+            resolve_interval_ = std::chrono::seconds(std::stoul(cfg["resolve_interval"].get<std::string>()));
+    } catch (const std::exception& e) {
+        spdlog::warn("CgroupCollector: bad config, using defaults: {}", e.what());
+    }
+    if (root_.empty()) root_ = detectRoot();
+    if (root_.empty()) {
+        spdlog::error("CgroupCollector: no cgroup v2 hierarchy found");
+        return false;
+    }
+    while (root_.size() > 1 && root_.back() == '/') root_.pop_back();
+    spdlog::info("CgroupCollector: using cgroup v2 root {}", root_);
+    return true;
+}
+
+CollectResult CgroupCollector::collect(const Job& job) {
+    std::lock_guard lg(mtx_);
+    return collectLocked(job, nullptr);
+}
+
+std::vector<CollectResult> CgroupCollector::collectBatch(const std::vector<JobPtr>& jobs) {
+    /* 一次加锁完成整个周期；多个作业落在同一 cgroup 时（例如共享父 cgroup）只读一次 */
+    std::vector<CollectResult> results;
+    results.reserve(jobs.size());
+    std::unordered_map<std::string, cgroup_info> tick_cache;
+    std::lock_guard lg(mtx_);
+    for (const auto& job : jobs) results.push_back(collectLocked(*job, &tick_cache));
+    return results;
+}
+
+CollectResult CgroupCollector::collectLocked(const Job& job, std::unordered_map<std::string, cgroup_info>* tick_cache) {
+    auto batch = std::make_shared<SampleBatch>(cgroupSchema());
+    if (root_.empty()) return batch;
+
+    auto now = std::chrono::steady_clock::now();
+    auto& cg = jobs_[job.JobID];
+    cg.lastSeen = now;
+
+    /* 首次采样、到了重新解析的时间（进程可能被迁移）、或解析所用的 PID 已离开作业 */
+    bool stale = now - cg.resolved >= resolve_interval_ ||
+                 (cg.dirFd >= 0 &&
+                  std::find(job.JobPIDs.begin(), job.JobPIDs.end(), cg.anchorPid) == job.JobPIDs.end());
+    if (stale) resolve(job, cg);
+    if (cg.dirFd < 0) return batch;     // 解析失败：保留条目作为负缓存，到期前不再读 /proc/<pid>/cgroup
+
+    if (tick_cache) {
+        auto hit = tick_cache->find(cg.path);
+        if (hit != tick_cache->end()) {
+            hit->second.jobId = job.JobID;
+            appendRow(*batch, hit->second);
+            rates_.apply(*batch, now);
+            return batch;
+        }
+    }
+
+    char* buf = procfs::thread_buffer();
+    cgroup_info local;
+    cgroup_info* info = &local;
+    if (tick_cache) info = &(*tick_cache)[cg.path];
+    info->jobId = job.JobID;
+    info->path = cg.path;
+    info->ino = cg.ino;
+
+    ssize_t n = readFile(cg, kCpuStat, buf, procfs::kReadBufSize);
+    if (n < 0) {
+        /* cpu.stat 总是存在，读失败说明 cgroup 已被删除，下周期重新解析 */
+        spdlog::debug("CgroupCollector: cgroup {} of job {} is gone", cg.path, job.JobID);
+        jobs_.erase(job.JobID);
+        if (tick_cache) tick_cache->erase(cg.path);
+        return batch;
+    }
+    parseCpuStat(buf, static_cast<std::size_t>(n), *info);
+
+    n = readFile(cg, kMemCurrent, buf, procfs::kReadBufSize);
+    if (n > 0) {
+        const char* p = buf;
+        procfs::scan_u64(p, buf + n, info->memCurrent);
+    }
+    n = readFile(cg, kMemStat, buf, procfs::kReadBufSize);
+    if (n > 0) parseMemStat(buf, static_cast<std::size_t>(n), *info);
+    n = readFile(cg, kIoStat, buf, procfs::kReadBufSize);
+    if (n > 0) parseIoStat(buf, static_cast<std::size_t>(n), *info);
+    n = readFile(cg, kMemEvents, buf, procfs::kReadBufSize);
+    if (n > 0) parseMemEvents(buf, static_cast<std::size_t>(n), *info);
+
+    appendRow(*batch, *info);
+    rates_.apply(*batch, now);
+    return batch;
+}
+
+bool CgroupCollector::activity(const CollectResult& result, JobActivity& out) const {
+    using namespace cols;
+    if (!result || result->empty() || &result->schema() != &cgroupSchema()) return false;
+    out.cpuSeconds = static_cast<double>(result->column(kCpuUsageUs)[0]) / 1e6;
+    out.ioBytes    = result->column(kIoReadBytes)[0] + result->column(kIoWriteBytes)[0];
+    return true;
+}
+
+void CgroupCollector::deinit() noexcept {
+    std::lock_guard lg(mtx_);
+    if (!jobs_.empty()) spdlog::info("CgroupCollector deinit");
+    jobs_.clear();
+    rates_.clear();
+}
+
+namespace {
+    struct AutoReg {
+        AutoReg() {
+            CollectorRegistry::instance().registerCollector<CgroupCollector>(COLLECTOR_TYPE_CGROUP);
+        }
+    };
+    static AutoReg _auto_reg;
+}
+
+} // namespace cgroup_collector
@@ -17,10 +17,16 @@ CollectorHandle CollectorRegistry::createCollector(const std::string& name) cons
         return {};                     // 空句柄，调用方可判空
 
     auto impl = std::shared_ptr<ICollector>(it->second().release()); // 创建采集器实例并转为shared_ptr
+    CollectBatchFunc batch;
+    if (impl->batched())
+        batch = [impl](const std::vector<JobPtr>& jobs) { return impl->collectBatch(jobs); };
     return {
         [impl](const nlohmann::json& cfg) { return impl->init(cfg); },
         [impl](const Job& job) { return impl->collect(job); },
-        [impl](){ impl->deinit(); }
+        [impl](){ impl->deinit(); },
+        [impl](const TickContext& ctx) { impl->beginTick(ctx); },
+        [impl](const CollectResult& r, JobActivity& out) { return impl->activity(r, out); },
+        std::move(batch)
     };
 }
 
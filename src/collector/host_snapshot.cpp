@@ -0,0 +1,22 @@
+#include "collector/host_snapshot.hpp"
+#include "collector/procfs_reader.hpp"
+
+#include <unistd.h>
+
+HostSnapshot HostSnapshot::capture() {
+    /* 时钟频率在进程生命周期内不变；在线核数可能因热插拔变化，每周期取一次 */
+    static const long hz = sysconf(_SC_CLK_TCK);
+
+    HostSnapshot s;
+    s.hz = hz;
+    s.numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    s.captured = std::chrono::steady_clock::now();
+
+    char* buf = procfs::thread_buffer();
+    ssize_t n = procfs::read_file("/proc/stat", buf, procfs::kReadBufSize);
+    if (n > 0) procfs::parse_cpu_total(buf, static_cast<std::size_t>(n), s.cpuTotal);
+
+    n = procfs::read_file("/proc/meminfo", buf, procfs::kReadBufSize);
+    if (n > 0) procfs::parse_meminfo_total(buf, static_cast<std::size_t>(n), s.memTotalKb);
+    return s;
+}
@@ -0,0 +1,100 @@
+#include "collector/job_ctl_codec.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace job_ctl {
+
+std::vector<Record> decode(const char* buf, std::size_t len) {
+    std::vector<Record> records;
+    for (std::size_t off = 0; off < len;) {
+        Record rec;
+        jl_rec_hdr h{};
+        if (len - off >= sizeof(h)) std::memcpy(&h, buf + off, sizeof(h));
+        rec.ack.seq    = h.seq;
+        rec.ack.job_id = h.job_id;
+        std::size_t payload = std::size_t(h.n_pids) * sizeof(std::int32_t) + h.lens_bytes;
+        if (len - off < sizeof(h) || h.magic != JL_MAGIC || h.version != JL_VERSION ||
+            h.len > len - off || h.len != sizeof(h) + payload) {
+            /* 长度不可信，后面的记录无法定位，整包到此为止 */
+            spdlog::warn("JobRegistry: malformed job_ctl record at offset {}", off);
+            rec.ack.status = JL_E_PROTO;
+            records.push_back(rec);
+            break;
+        }
+        const char* p = buf + off + sizeof(h);
+        off += h.len;
+
+        std::vector<int> pids(h.n_pids);
+        if (h.n_pids) std::memcpy(pids.data(), p, h.n_pids * sizeof(std::int32_t));
+        p += h.n_pids * sizeof(std::int32_t);
+        std::vector<std::string> lens;
+        bool valid = h.lens_bytes == 0 || p[h.lens_bytes - 1] == '\0';
+        for (const char* name = p; valid && name < p + h.lens_bytes; name += std::strlen(name) + 1) {
+            if (*name) lens.emplace_back(name);
+        }
+        valid = valid && std::all_of(pids.begin(), pids.end(), [](int pid) { return pid > 0; });
+        /* JobID 0 保留给 lens_stats 等守护进程级记录，负数同样无意义 */
+        bool idValid = h.job_id > 0;
+        valid = valid && idValid;
+        if ((h.flags & JL_F_FREQ) && !validSampleFreq(h.freq)) valid = false;
+
+        Request req;
+        bool ok = false;
+        switch (h.op) {
+            case JL_OP_ADD:
+                if (!valid || !(h.flags & JL_F_PIDS) || !(h.flags & JL_F_LENS) || pids.empty()) break;
+                req.kind               = Request::Kind::Add;
+                req.job.JobID          = h.job_id;
+                req.job.JobPIDs        = std::move(pids);
+                req.job.CollectorNames = std::move(lens);
+                if (h.flags & JL_F_FREQ) req.job.SampleFreq = h.freq;
+                if (h.flags & JL_F_CTIME)
+                    req.job.JobCreateTime = std::chrono::system_clock::time_point(std::chrono::seconds(h.create_time));
+                ok = true;
+                break;
+            case JL_OP_REMOVE:
+                if (!idValid) break;
+                req.kind      = Request::Kind::Remove;
+                req.job.JobID = h.job_id;
+                ok = true;
+                break;
+            case JL_OP_UPDATE:
+            case JL_OP_ATTACH:
+            case JL_OP_DETACH:
+                if (!valid) break;
+                req.kind         = Request::Kind::Update;
+                req.update.JobID = h.job_id;
+                req.update.mode  = h.op == JL_OP_UPDATE ? JobUpdate::Mode::Replace
+                                 : h.op == JL_OP_ATTACH ? JobUpdate::Mode::Attach : JobUpdate::Mode::Detach;
+                if (h.flags & JL_F_PIDS) req.update.JobPIDs = std::move(pids);
+                if (h.flags & JL_F_LENS) req.update.CollectorNames = std::move(lens);
+                if (h.op == JL_OP_UPDATE && (h.flags & JL_F_FREQ)) req.update.SampleFreq = h.freq;
+                ok = true;
+                break;
+            default:
+                break;
+        }
+
+        if (ok) {
+            rec.ack.status = JL_OK;
+            rec.req = std::move(req);
+        } else {
+            spdlog::warn("JobRegistry: invalid job_ctl op {} for job {}", h.op, h.job_id);
+            rec.ack.status = JL_E_INVAL;
+        }
+        records.push_back(std::move(rec));
+    }
+    return records;
+}
+
+std::string encodeAcks(const std::vector<jl_ack>& acks) {
+    jl_ack_hdr ah{JL_MAGIC, JL_VERSION, static_cast<std::uint16_t>(acks.size())};
+    std::string reply(sizeof(ah) + acks.size() * sizeof(jl_ack), '\0');
+    std::memcpy(reply.data(), &ah, sizeof(ah));
+    if (!acks.empty()) std::memcpy(reply.data() + sizeof(ah), acks.data(), acks.size() * sizeof(jl_ack));
+    return reply;
+}
+
+} // namespace job_ctl
@@ -1,6 +1,9 @@
 #include "collector/job_info_collector.hpp"
 #include "collector/collector_registry.hpp"
 #include "collector/job_registry.hpp"
+#include "collector/process_tree.hpp"
+#include "collector/tick_arena.hpp"
+#include "collector/tick_budget.hpp"
 #include <sstream>
 #include "common/config.hpp"
 
@@ -10,6 +13,8 @@
 #include <cerrno>     // errno
 #include <cstring>    // strerror
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
 #include <string>
 
 #include <iostream>
@@ -21,12 +26,41 @@ JobInfoCollector::JobInfoCollector()
             if (e == JobEvent::Added){
                 addJobCollect(job);
             }
+            if (e == JobEvent::Updated){
+                updateJobCollect(job);
+            }
             if (e == JobEvent::Removed){
                 rmJobCollect(job);
             }
         }
     );
     
+    try {
+        track_descendants_ = global_config.getBool("lens_config", "track_descendants");
+    } catch (const std::exception& e) {
+        spdlog::warn("JobInfoCollector: lens_config.track_descendants not set, default on");
+    }
+
+    try {
+        auto name = global_config.getString("lens_config", "missed_tick_policy");
+        if (!TimerScheduler::parsePolicy(name, missed_tick_policy_))
+            spdlog::warn("JobInfoCollector: unknown missed_tick_policy {}, default coalesce", name);
+    } catch (const std::exception& e) {
+        spdlog::warn("JobInfoCollector: lens_config.missed_tick_policy not set, default coalesce");
+    }
+
+    try {
+        tick_budget_ = global_config.getDouble("lens_config", "tick_budget");
+    } catch (const std::exception& e) {
+        spdlog::warn("JobInfoCollector: lens_config.tick_budget not set, default {}", tick_budget_);
+    }
+
+    try {
+        liveness_interval_ = global_config.getDouble("lens_config", "liveness_interval");
+    } catch (const std::exception& e) {
+        spdlog::warn("JobInfoCollector: lens_config.liveness_interval not set, default {}s", liveness_interval_);
+    }
+
     registerCollectFuncs();
     registerFinishCallbacks();
     spdlog::info("JobInfoCollector: initialized with {} collect functions and {} finish callbacks",
@@ -59,7 +93,6 @@ nlohmann::json yamlToJson(const YAML::Node& node) {
 
 
 void JobInfoCollector::startCollector(std::string collector_name){
-    std::function<std::any(Job&)> func_handle;
     collector_info info; 
     std::string config_name;
     try
@@ -69,6 +102,9 @@ void JobInfoCollector::startCollector(std::string collector_name){
     catch(const std::exception& e)
     {
         spdlog::error("JobInfoCollector: start collector error, can not find {}!",collector_name);
+        auto& state = collector_state_dict.at(collector_name);
+        std::lock_guard lg(state.m_);
+        state.running = false;
         return;
     }
     auto config_node = Config::instance().getRawNode(info.config_name);
@@ -76,15 +112,58 @@ void JobInfoCollector::startCollector(std::string collector_name){
     info.init_handle(j_config);
     auto freq = Config::instance().getInt(info.config_name, "freq");
 
-    auto& collector_job = collector_state_dict[collector_name];
+    /* 采集器可单独指定错过周期的处理方式，否则使用全局设置 */
+    auto policy = missed_tick_policy_;
+    if (j_config.is_object() && j_config.contains("missed_tick_policy") && j_config["missed_tick_policy"].is_string()) {
+        auto name = j_config["missed_tick_policy"].get<std::string>();
+        if (!TimerScheduler::parsePolicy(name, policy))
+            spdlog::warn("JobInfoCollector: unknown missed_tick_policy {} for {}", name, collector_name);
+    }
+    /* 启用周期预算时每个采集器最多挂起一个周期，补采会让过载的节点更加过载 */
+    if (tick_budget_ > 0 && policy == TimerScheduler::MissedTickPolicy::CatchUp) {
+        spdlog::warn("JobInfoCollector: collector {} uses catch_up with tick_budget enabled, falling back to coalesce",
+                     collector_name);
+        policy = TimerScheduler::MissedTickPolicy::Coalesce;
+    }
+    const auto budget = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::duration<double, std::milli>(tick_budget_ * 1000.0 / freq));
 
-    
-    collector_job.task_id = timerScheduler_.registerRepeatingTimer(
-        std::chrono::milliseconds(1000/freq),
-        [this, collector_name](){
-            auto& info = collector_info_dict[collector_name];
-            auto& collector_job = collector_state_dict[collector_name];
-            
+    /* 自适应采样：freq 为上限，min_freq 为下限 */
+    adaptive_config adaptive;
+    try {
+        if (j_config.contains("adaptive"))
+            adaptive.enabled = j_config["adaptive"].get<std::string>() == "true";
+        double min_freq = freq;
+        if (j_config.contains("min_freq"))
+            min_freq = std::stod(j_config["min_freq"].get<std::string>());
+        if (min_freq > 0 && min_freq < freq)
+            adaptive.max_stride = static_cast<uint32_t>(freq / min_freq);
+        if (j_config.contains("adaptive_cpu_delta"))
+            adaptive.cpu_delta = std::stod(j_config["adaptive_cpu_delta"].get<std::string>());
+        if (j_config.contains("adaptive_io_delta"))
+            adaptive.io_delta = std::stod(j_config["adaptive_io_delta"].get<std::string>());
+    } catch (const std::exception& e) {
+        spdlog::warn("JobInfoCollector: bad adaptive config for {}: {}", collector_name, e.what());
+    }
+    if (adaptive.enabled)
+        spdlog::info("JobInfoCollector: collector {} adaptive sampling between {} Hz and {:.3f} Hz",
+                     collector_name, freq, static_cast<double>(freq) / adaptive.max_stride);
+
+    auto& collector_job = collector_state_dict.at(collector_name);
+
+    std::lock_guard lg(collector_job.m_);
+    collector_job.adaptive = adaptive;
+    collector_job.task_id = timerScheduler_.registerAlignedTimer(
+        std::chrono::milliseconds(1000/freq), policy,
+        [this, collector_name, freq, budget](const TimerScheduler::Tick& tick){
+            auto& info = collector_info_dict.at(collector_name);
+            auto& collector_job = collector_state_dict.at(collector_name);
+
+            /* 锁内只挑出本周期到期的作业，采集期间不持锁，增删作业不会被采集阻塞；
+               按上次采集的周期排序，上周期因超出预算被跳过的作业排在最前 */
+            std::vector<std::pair<uint64_t, int>> due;
+            std::vector<int> jobids;
+            uint64_t seq;
             {
                 std::lock_guard lg(collector_job.m_);
                 if(collector_job.jobid_list.size() == 0){
@@ -92,44 +171,202 @@ void JobInfoCollector::startCollector(std::string collector_name){
                     //没有任务，取消这个收集器，节省资源
                     info.deinit_handle();
                     timerScheduler_.cancelTimer(collector_job.task_id);
+                    collector_job.running = false;
+                    return;
+                }
+                seq = ++collector_job.tick_seq;
+                for (int id : collector_job.jobid_list) {
+                    auto& s = collector_job.sched[id];
+                    if (seq >= s.next_seq) due.emplace_back(s.last_seq, id);
                 }
             }
+            collector_job.ticks.fetch_add(1, std::memory_order_relaxed);
+            if (tick.missed) {
+                collector_job.missed_ticks.fetch_add(tick.missed, std::memory_order_relaxed);
+                spdlog::debug("JobInfoCollector: collector {} missed {} ticks", collector_name, tick.missed);
+            }
+            /* 所有作业都处于退避中，本周期无事可做 */
+            if (due.empty()) return;
+            std::stable_sort(due.begin(), due.end(),
+                             [](const auto& a, const auto& b) { return a.first < b.first; });
+            jobids.reserve(due.size());
+            for (const auto& d : due) jobids.push_back(d.second);
 
-            for(auto jobid: collector_job.jobid_list){
-                //TODO:当压力过高时，这里应该改为非阻塞执行
-                auto job = JobRegistry::instance().findJob(jobid);
-                if(job == nullptr)continue;
+            /* 本周期的截止时间：整点 + 预算，换算到单调时钟 */
+            bool bounded = budget.count() > 0;
+            auto deadline = std::chrono::steady_clock::now() +
+                            (tick.scheduled + budget - std::chrono::system_clock::now());
 
+            /* 本周期的整机快照只读取一次，所有作业共享；
+               时间戳取对齐后的整点，同一周期的所有样本（跨作业、跨采集器）时间戳一致 */
+            TickContext ctx;
+            ctx.seq  = seq;
+            ctx.ts   = tick.scheduled;
+            ctx.host = std::make_shared<const HostSnapshot>(HostSnapshot::capture());
+            ctx.arena = TickArenaPool::instance().acquire();
+            if (info.tick_handle) info.tick_handle(ctx);
 
-                {
-                    std::lock_guard lg(collector_job.m_);
-                    std::any ret;
-                    try
-                    {
-                        ret = info.collect_handle(*job);
-                    }
-                    catch(const std::exception& e)
-                    {
-                        spdlog::error("JobInfoCollector: collector {} collect error: {}", collector_name, e.what());
-                        std::cerr << e.what() << '\n';
+            /* 整机只扫描一次 /proc，多个采集器同一周期的刷新会被合并 */
+            /* 事件模式下作业的 PID 列表已实时包含全部后代，无需扫描 */
+            bool expand = track_descendants_ && !JobRegistry::instance().eventTracking();
+            if (expand)
+                ProcessTree::instance().refresh(std::chrono::milliseconds(500 / freq));
+
+            /* 作业分摊到执行器的各工作线程，全部完成后本周期结束 */
+            enum : char { kSkipped = 0, kCollected, kActive };
+            std::vector<JobActivity> activity(jobids.size());
+            std::vector<char> result(jobids.size(), kSkipped);
+            if (info.batch_handle) {
+                /* 批量采集：每块作业一次调用，由采集器在块内分摊固定开销；
+                   超过截止时间后不再开始新的块，未开始的作业保持 kSkipped，下周期排在最前。
+                   分发给写入器的部分仍在执行器上并行 */
+                tick_budget::runChunks(jobids.size(), kBatchChunk, bounded, deadline,
+                                       [&](std::size_t begin, std::size_t end) {
+                    std::vector<JobPtr> jobs;
+                    std::vector<std::size_t> index;
+                    jobs.reserve(end - begin);
+                    for (std::size_t i = begin; i < end; ++i) {
+                        auto job = resolveJob(jobids[i], expand);
+                        if (!job) {
+                            result[i] = kCollected;
+                            continue;
+                        }
+                        jobs.push_back(std::move(job));
+                        index.push_back(i);
                     }
-                    for(auto& cb:finishCallbacks_){
-                        cb(collector_name, *job, ret, std::chrono::system_clock::now());
+                    std::vector<CollectResult> rets;
+                    try {
+                        TickArena::Scope scope(ctx.arena);
+                        rets = info.batch_handle(jobs);
+                    } catch (const std::exception& e) {
+                        spdlog::error("JobInfoCollector: collector {} batch collect error: {}", collector_name, e.what());
                     }
-                }
-                
+                    rets.resize(jobs.size());
+                    WorkStealingExecutor::instance().parallelFor(jobs.size(), [&](std::size_t k) {
+                        std::size_t i = index[k];
+                        result[i] = dispatch(info, collector_name, jobs[k], rets[k], ctx.ts, activity[i]) ? kActive : kCollected;
+                    });
+                });
+            } else {
+                /* 超过截止时间后剩余作业留到下个周期，但每周期至少采集一个（最久未采集的）作业 */
+                WorkStealingExecutor::instance().parallelFor(jobids.size(), [&](std::size_t i) {
+                    if (bounded && i > 0 && std::chrono::steady_clock::now() > deadline) return;
+                    TickArena::Scope scope(ctx.arena);
+                    result[i] = collectOne(info, collector_name, jobids[i], expand, ctx.ts, activity[i]) ? kActive : kCollected;
+                });
+            }
+
+            std::size_t skipped = std::count(result.begin(), result.end(), kSkipped);
+            if (skipped) {
+                collector_job.skipped_jobs.fetch_add(skipped, std::memory_order_relaxed);
+                spdlog::debug("JobInfoCollector: collector {} tick {} over budget, {} of {} jobs deferred",
+                              collector_name, seq, skipped, jobids.size());
+            }
+            if (bounded && std::chrono::steady_clock::now() > deadline)
+                collector_job.late_ticks.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard lg(collector_job.m_);
+            for (std::size_t i = 0; i < jobids.size(); ++i) {
+                if (result[i] == kSkipped) continue;   // 仍为到期状态，下周期优先
+                auto it = collector_job.sched.find(jobids[i]);
+                if (it == collector_job.sched.end()) continue;   // 采集期间作业已被移除
+                reschedule(it->second, collector_job.adaptive, freq, seq, ctx.ts,
+                           result[i] == kActive ? &activity[i] : nullptr);
             }
-            
         }
     );
     spdlog::info("JobInfoCollector: start collector {}", collector_name);
 
 }
 
-void JobInfoCollector::addJob2Collector(int jobid, std::string collector){
-    auto& state = collector_state_dict[collector];
-    state.jobid_list.push_back(jobid); 
-    if(!state.running){
+JobPtr JobInfoCollector::resolveJob(int jobid, bool expand){
+    auto found = JobRegistry::instance().findJob(jobid);
+    if(!found || !expand)return found;
+
+    /* 把作业登记的根 PID 展开为完整的进程树，所有采集器与写入器看到同一份 */
+    auto job = std::make_shared<Job>(*found);
+    job->JobPIDs = ProcessTree::instance().expand(found->JobPIDs);
+    return job;
+}
+
+bool JobInfoCollector::collectOne(const collector_info& info, const std::string& collector_name, int jobid, bool expand,
+                                  std::chrono::system_clock::time_point ts, JobActivity& activity){
+    auto job = resolveJob(jobid, expand);
+    if(!job)return false;
+
+    CollectResult ret;
+    try
+    {
+        ret = info.collect_handle(*job);
+    }
+    catch(const std::exception& e)
+    {
+        spdlog::error("JobInfoCollector: collector {} collect error: {}", collector_name, e.what());
+    }
+    return dispatch(info, collector_name, job, ret, ts, activity);
+}
+
+bool JobInfoCollector::dispatch(const collector_info& info, const std::string& collector_name, const JobPtr& job,
+                                const CollectResult& ret, std::chrono::system_clock::time_point ts, JobActivity& activity){
+    for(auto& cb:finishCallbacks_){
+        cb(collector_name, job, ret, ts);
+    }
+    return ret && info.activity_handle && info.activity_handle(ret, activity);
+}
+
+void JobInfoCollector::reschedule(job_sched& s, const adaptive_config& cfg, int freq, uint64_t seq,
+                                  std::chrono::system_clock::time_point ts, const JobActivity* activity){
+    if (s.freq > 0) {
+        /* 作业指定了频率：换算成步长，不超过采集器自身的频率，
+           也不低于 kMinSampleFreq（否则两次采样之间基线已被空闲回收） */
+        double max_stride = std::max(1.0, std::floor(freq / kMinSampleFreq));
+        s.stride = static_cast<uint32_t>(std::clamp(std::round(freq / s.freq), 1.0, max_stride));
+    } else if (!cfg.enabled || !activity) {
+        s.stride = 1;
+    } else {
+        bool changed = true;
+        if (s.has_last) {
+            double dt = std::chrono::duration<double>(ts - s.last_ts).count();
+            if (dt > 0) {
+                /* 进程退出会使累计值回落，差值为负同样视为变化 */
+                double cpu_rate = (activity->cpuSeconds - s.last.cpuSeconds) / dt;
+                double io_rate  = (static_cast<double>(activity->ioBytes) - static_cast<double>(s.last.ioBytes)) / dt;
+                changed = !s.has_rate || cpu_rate < 0 || io_rate < 0 ||
+                          std::fabs(cpu_rate - s.cpu_rate) > cfg.cpu_delta ||
+                          std::fabs(io_rate - s.io_rate) > cfg.io_delta;
+                s.cpu_rate = cpu_rate;
+                s.io_rate  = io_rate;
+                s.has_rate = true;
+            }
+        }
+        s.stride = changed ? 1 : std::min(s.stride * 2, cfg.max_stride);
+        s.last     = *activity;
+        s.last_ts  = ts;
+        s.has_last = true;
+    }
+    s.last_seq = seq;
+    s.next_seq = seq + s.stride;
+}
+
+void JobInfoCollector::addJob2Collector(int jobid, double freq, std::string collector){
+    auto it = collector_state_dict.find(collector);
+    if (it == collector_state_dict.end()) {
+        spdlog::error("JobInfoCollector: job {} requests unknown collector {}", jobid, collector);
+        return;
+    }
+    auto& state = it->second;
+    bool start = false;
+    {
+        std::lock_guard lg(state.m_);
+        state.jobid_list.push_back(jobid);
+        state.sched[jobid] = job_sched{};
+        state.sched[jobid].freq = freq;
+        if (!state.running) {
+            state.running = true;
+            start = true;
+        }
+    }
+    if(start){
         startCollector(collector);
     }
 }
@@ -137,32 +374,64 @@ void JobInfoCollector::addJob2Collector(int jobid, std::string collector){
 void JobInfoCollector::addJobCollect(const Job& job){
     std::lock_guard lg(m_);
     for(auto collector_name:job.CollectorNames){
-        addJob2Collector(job.JobID, collector_name);
+        addJob2Collector(job.JobID, job.SampleFreq, collector_name);
     }
 }
 
+/* 作业的采集器列表可能已被增量修改过，按各采集器实际持有的作业清理 */
 void JobInfoCollector::rmJobCollect(const Job& job){
-    for(auto collector_name:job.CollectorNames){
-        try
-        {
-            auto& state = collector_state_dict.at(collector_name);
-            int id = job.JobID;
-            state.jobid_list.erase(std::remove_if(state.jobid_list.begin(),state.jobid_list.end(),[id](int x){return x==id;}));
+    for (auto& [collector_name, state] : collector_state_dict) {
+        int id = job.JobID;
+        std::lock_guard lg(state.m_);
+        state.jobid_list.erase(std::remove(state.jobid_list.begin(), state.jobid_list.end(), id),
+                               state.jobid_list.end());
+        state.sched.erase(id);
+    }
+}
+
+/* 作业属性变更：只调整受影响的采集器。仍保留的采集器沿用原有的调度状态，
+   新增的采集器按需启动，移出的采集器在没有作业后按原逻辑自行停止；PID 变化无需处理，
+   每个周期都会从 JobRegistry 取到最新的作业 */
+void JobInfoCollector::updateJobCollect(const Job& job){
+    std::lock_guard lg(m_);
+    const auto& wanted = job.CollectorNames;
+    for (auto& [collector_name, state] : collector_state_dict) {
+        bool keep = std::find(wanted.begin(), wanted.end(), collector_name) != wanted.end();
+        std::lock_guard slg(state.m_);
+        auto it = state.sched.find(job.JobID);
+        if (it == state.sched.end()) continue;
+        if (keep) {
+            it->second.freq = job.SampleFreq;
+            continue;
         }
-        catch(const std::exception& e)
-        {
-            spdlog::error("JobInfoCollector: collector {} remove job {} error beacause {}",collector_name,job.JobID,e.what());
+        state.sched.erase(it);
+        state.jobid_list.erase(std::remove(state.jobid_list.begin(), state.jobid_list.end(), job.JobID),
+                               state.jobid_list.end());
+        spdlog::info("JobInfoCollector: job {} detached from collector {}", job.JobID, collector_name);
+    }
+    for (const auto& collector_name : wanted) {
+        auto it = collector_state_dict.find(collector_name);
+        if (it != collector_state_dict.end()) {
+            std::lock_guard slg(it->second.m_);
+            if (it->second.sched.count(job.JobID)) continue;
         }
+        addJob2Collector(job.JobID, job.SampleFreq, collector_name);
+        spdlog::info("JobInfoCollector: job {} attached to collector {}", job.JobID, collector_name);
     }
 }
 
-void JobInfoCollector::addCollectFunc(std::string name, std::string config, CollectFunc collector_handle,CollectInitFunc init_handle,CollectDeinitFunc deinit_handle) {
+void JobInfoCollector::addCollectFunc(std::string name, std::string config, CollectFunc collector_handle,CollectInitFunc init_handle,CollectDeinitFunc deinit_handle,CollectTickFunc tick_handle,CollectActivityFunc activity_handle,CollectBatchFunc batch_handle) {
     std::lock_guard lg(m_);
     collector_info_dict[name].name = name;
     collector_info_dict[name].config_name = config;
     collector_info_dict[name].collect_handle = collector_handle;
     collector_info_dict[name].init_handle = init_handle;
     collector_info_dict[name].deinit_handle = deinit_handle;
+    collector_info_dict[name].tick_handle = tick_handle;
+    collector_info_dict[name].activity_handle = activity_handle;
+    collector_info_dict[name].batch_handle = batch_handle;
+    /* 状态表只在注册阶段插入，采集周期内并发访问时不会发生 rehash */
+    collector_state_dict[name];
 }   
 
 void JobInfoCollector::addCallback(OnFinish cb) {
@@ -187,19 +456,78 @@ void JobInfoCollector::onJobLifecycle(JobEvent ev, Job& job) {
     }
 }
 
-inline bool isPidAlive(pid_t pid)
-{
-    if (pid <= 0) return false;
-    if (kill(pid, 0) == 0) return true;          // 存在
-    if (errno == ESRCH) return false;              // 不存在
-    // 其它错误码（如 EPERM）统一视为“不可发信号”，也算“不存在”
-    return false;
-}
-
 void JobInfoCollector::start() {
     std::lock_guard lg(m_);
     if (running_) return;
     running_ = true;
+    stats_task_ = timerScheduler_.registerRepeatingTimer(kStatsInterval, [this] { reportStats(); });
+
+    /* 作业存活检查与采集周期分开：查找作业时不再逐个探测 PID；
+       pidfd 可用时根进程退出已实时处理，定时器只兜底“根进程已退出、后代仍在运行”的作业 */
+    if (!JobRegistry::instance().eventTracking() && liveness_interval_ > 0) {
+        auto interval = std::chrono::duration_cast<TimerScheduler::Duration>(
+            std::chrono::duration<double>(liveness_interval_));
+        reap_task_ = timerScheduler_.registerRepeatingTimer(interval, [] { JobRegistry::instance().reapExited(); });
+    }
+}
+
+namespace {
+
+namespace lens_stats_cols {
+inline constexpr Col<std::string_view> kCollector{0, "collector"};
+inline constexpr Col<std::int64_t>     kJobs{1, "jobs"};
+inline constexpr Col<std::uint64_t>    kTicks{2, "ticks"};
+inline constexpr Col<std::uint64_t>    kLateTicks{3, "late_ticks"};
+inline constexpr Col<std::uint64_t>    kMissedTicks{4, "missed_ticks"};
+inline constexpr Col<std::uint64_t>    kSkippedJobs{5, "skipped_jobs"};
+} // namespace lens_stats_cols
+
+const Schema& lensStatsSchema() {
+    using namespace lens_stats_cols;
+    static const Schema schema("lens_stats", int8_t(CollectorType::LensStats), {
+        Schema::column(kCollector), Schema::column(kJobs), Schema::column(kTicks),
+        Schema::column(kLateTicks), Schema::column(kMissedTicks), Schema::column(kSkippedJobs),
+    });
+    return schema;
+}
+
+} // namespace
+
+void JobInfoCollector::reportStats() {
+    using namespace lens_stats_cols;
+    auto batch = std::make_shared<SampleBatch>(lensStatsSchema());
+    batch->reserve(collector_state_dict.size());
+    for (auto& [name, state] : collector_state_dict) {
+        std::size_t jobs;
+        {
+            std::lock_guard lg(state.m_);
+            jobs = state.jobid_list.size();
+        }
+        uint64_t late    = state.late_ticks.load(std::memory_order_relaxed);
+        uint64_t missed  = state.missed_ticks.load(std::memory_order_relaxed);
+        uint64_t skipped = state.skipped_jobs.load(std::memory_order_relaxed);
+
+        std::size_t r = batch->appendRow();
+        batch->setInterned(r, kCollector, name);
+        batch->set(r, kJobs, static_cast<std::int64_t>(jobs));
+        batch->set(r, kTicks, state.ticks.load(std::memory_order_relaxed));
+        batch->set(r, kLateTicks, late);
+        batch->set(r, kMissedTicks, missed);
+        batch->set(r, kSkippedJobs, skipped);
+
+        uint64_t total = late + missed + skipped;
+        if (total == state.logged_overload) continue;   // 上次输出以来没有新的过载
+        state.logged_overload = total;
+        spdlog::warn("JobInfoCollector: collector {} overloaded: {} late ticks, {} missed ticks, {} deferred jobs",
+                     name, late, missed, skipped);
+    }
+
+    /* 守护进程级别的记录不属于任何作业：JobID 0 即表示这一点（FIFO 与 job_ctl socket 都拒绝
+       JobID <= 0 的作业），写入器按 collector_name（lens_stats）路由，ES 的索引映射见配置中的 indexs */
+    static const JobPtr lens_job = std::make_shared<const Job>();
+    CollectResult ret = std::move(batch);
+    auto ts = std::chrono::system_clock::now();
+    for (auto& cb : finishCallbacks_) cb("lens_stats", lens_job, ret, ts);
 }
 
 void JobInfoCollector::shutdown() {
@@ -210,6 +538,8 @@ void JobInfoCollector::shutdown() {
     }
     timerScheduler_.shutdown();
     writer_manager::instance().shutdown();
+    WorkStealingExecutor::writerInstance().shutdown();
+    WorkStealingExecutor::instance().shutdown();
     spdlog::info("JobInfoCollector: writer_manager shutdown complete");
 }
 
@@ -254,7 +584,10 @@ void JobInfoCollector::registerCollectFuncs() {
             collector.config,
             collector_handle.collect,
             collector_handle.init,
-            collector_handle.deinit
+            collector_handle.deinit,
+            collector_handle.tick,
+            collector_handle.activity,
+            collector_handle.batch
         );
     }
 }
@@ -4,28 +4,46 @@
 #include "common/streamer_watcher.hpp"
 #include <date/date.h>
 #include "common/config.hpp"
+#include "collector/process_tree.hpp"
+#include "client/joblens_ctl.h"
+#include "collector/job_ctl_codec.hpp"
 #include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
 
-std::string string2JobOpt(const std::string& str, Job& job) {
+namespace {
 
+/* JobID 0 保留给 lens_stats 等守护进程级记录，与 job_ctl socket 一样拒绝非正数 */
+int json2JobID(const nlohmann::json& j) {
+    int id = j.at("JobID").get<int>();
+    if (id <= 0) throw std::invalid_argument(fmt::format("JobID {} must be positive", id));
+    return id;
+}
 
-    nlohmann::json j = nlohmann::json::parse(str);
-    auto opt = j["opt"].get<std::string>();
-    job.JobID = j["JobID"].get<int>();
-    job.JobPIDs = j["JobPIDs"].get<std::vector<int>>();
-    job.CollectorNames = j["Lens"].get<std::vector<std::string>>();
+Job json2Job(const nlohmann::json& j) {
+    Job job;
+    job.JobID = json2JobID(j);
+    job.JobPIDs = j.at("JobPIDs").get<std::vector<int>>();
+    job.CollectorNames = j.at("Lens").get<std::vector<std::string>>();
+    if (j.contains("Freq") && j.at("Freq").is_number())
+        job.SampleFreq = j.at("Freq").get<double>();
+    if (!validSampleFreq(job.SampleFreq))
+        throw std::invalid_argument(fmt::format("job ID {} Freq {} must be 0 or at least {:.4f} Hz",
+                                                job.JobID, job.SampleFreq, kMinSampleFreq));
     if (job.JobPIDs.size() == 0) {
         spdlog::warn("JobRegistry: job ID {} has empty PID list", job.JobID);
     }
     for (auto pid: job.JobPIDs) {
-        if (pid > 0) {
+        if (pid <= 0) {
             spdlog::warn("JobRegistry: invalid PID {} in job ID {}", pid, job.JobID);
         }
     }
     try
     {
         date::sys_seconds tp;
-        std::istringstream in{j["JobCreateTime"].get<std::string>()};
+        std::istringstream in{j.at("JobCreateTime").get<std::string>()};
         in >> date::parse("%F %T", tp);
         job.JobCreateTime = tp;
     }
@@ -33,37 +51,211 @@ std::string string2JobOpt(const std::string& str, Job& job) {
     {
         spdlog::warn("JobRegistry: error parsing JobCreateTime for job ID {}: {}", job.JobID, e.what());
     }
-    return opt;
-    
+    return job;
+}
+
+/* update / attach / detach 消息只需带上要修改的字段 */
+JobUpdate json2JobUpdate(const nlohmann::json& j, JobUpdate::Mode mode) {
+    JobUpdate u;
+    u.JobID = json2JobID(j);
+    u.mode  = mode;
+    if (j.contains("JobPIDs"))
+        u.JobPIDs = j.at("JobPIDs").get<std::vector<int>>();
+    if (j.contains("Lens"))
+        u.CollectorNames = j.at("Lens").get<std::vector<std::string>>();
+    if (mode == JobUpdate::Mode::Replace && j.contains("Freq") && j.at("Freq").is_number())
+        u.SampleFreq = j.at("Freq").get<double>();
+    if (u.SampleFreq && !validSampleFreq(*u.SampleFreq))
+        throw std::invalid_argument(fmt::format("job ID {} Freq {} must be 0 or at least {:.4f} Hz",
+                                                u.JobID, *u.SampleFreq, kMinSampleFreq));
+    return u;
+}
+
+/* 把 src 中的元素并入 / 移出 dst，返回实际发生变化的元素 */
+template <typename T>
+std::vector<T> mergeInto(std::vector<T>& dst, const std::vector<T>& src) {
+    std::vector<T> added;
+    for (const auto& v : src) {
+        if (std::find(dst.begin(), dst.end(), v) != dst.end()) continue;
+        dst.push_back(v);
+        added.push_back(v);
+    }
+    return added;
+}
+
+template <typename T>
+std::vector<T> removeFrom(std::vector<T>& dst, const std::vector<T>& src) {
+    std::vector<T> removed;
+    for (const auto& v : src) {
+        auto it = std::find(dst.begin(), dst.end(), v);
+        if (it == dst.end()) continue;
+        dst.erase(it);
+        removed.push_back(v);
+    }
+    return removed;
 }
 
+std::uint16_t statusOf(JobRegistry::OpResult r) {
+    switch (r) {
+        case JobRegistry::OpResult::Applied:     return JL_OK;
+        case JobRegistry::OpResult::Duplicate:   return JL_E_EXISTS;
+        case JobRegistry::OpResult::NotFound:    return JL_E_NOENT;
+    }
+    return JL_E_INVAL;
+}
+
+} // namespace
+
+void JobRegistry::onJobOpt(const char* buf, std::size_t len) {
+    std::vector<JobOp> ops;
+    std::size_t total = 0;
+    const char* end = buf + len;
+    for (const char* line = buf; line < end;) {
+        const char* nl = std::find(line, end, '\n');
+        const char* next = nl == end ? end : nl + 1;
+        if (std::all_of(line, nl, [](char c) { return std::isspace(static_cast<unsigned char>(c)); })) {
+            line = next;
+            continue;
+        }
+        ++total;
+
+        std::string opt;
+        std::optional<JobUpdate> update;
+        try
+        {
+            nlohmann::json j = nlohmann::json::parse(line, nl);
+            opt = j.at("opt").get<std::string>();
+            if (opt == "add") ops.push_back({JobOp::Kind::Add, json2Job(j)});
+            else if (opt == "remove") {
+                Job job;
+                job.JobID = json2JobID(j);
+                ops.push_back({JobOp::Kind::Remove, std::move(job)});
+            }
+            else if (opt == "update") update = json2JobUpdate(j, JobUpdate::Mode::Replace);
+            else if (opt == "attach") update = json2JobUpdate(j, JobUpdate::Mode::Attach);
+            else if (opt == "detach") update = json2JobUpdate(j, JobUpdate::Mode::Detach);
+            else spdlog::warn("JobRegistry: unknown job opt {}", opt);
+        }
+        catch(const std::exception& e)
+        {
+            spdlog::error("JobRegistry: job_opt parse error: {}",e.what());
+        }
+        line = next;
+
+        /* update 类消息较少，逐条执行；先把之前攒下的增删落地以保持顺序 */
+        if (update) {
+            applyOps(ops);
+            ops.clear();
+            if (updateJob(*update) == OpResult::NotFound)
+                spdlog::warn("JobRegistry: {} for unknown job {}, ignored", opt, update->JobID);
+        }
+    }
+    applyOps(ops);
+    spdlog::debug("JobRegistry: handled {} job_opt messages", total);
+}
+
+std::string JobRegistry::onJobCtl(const char* buf, std::size_t len) {
+    auto records = job_ctl::decode(buf, len);
+    std::vector<jl_ack> acks;
+    acks.reserve(records.size());
+    std::vector<JobOp> ops;
+    std::vector<std::size_t> opAck;   // ops[i] 对应 acks[opAck[i]]
+    auto flush = [&] {
+        applyOps(ops);
+        for (std::size_t i = 0; i < ops.size(); ++i) acks[opAck[i]].status = statusOf(ops[i].result);
+        ops.clear();
+        opAck.clear();
+    };
+
+    for (auto& rec : records) {
+        acks.push_back(rec.ack);
+        if (!rec.req) continue;
+        auto& req = *rec.req;
+        if (req.kind == job_ctl::Request::Kind::Update) {
+            /* 与 FIFO 一致：先落地之前的增删再逐条执行 update，保持顺序 */
+            flush();
+            acks.back().status = statusOf(updateJob(req.update));
+            continue;
+        }
+        opAck.push_back(acks.size() - 1);
+        ops.push_back({req.kind == job_ctl::Request::Kind::Add ? JobOp::Kind::Add : JobOp::Kind::Remove,
+                       std::move(req.job)});
+    }
+    flush();
+
+    spdlog::debug("JobRegistry: handled {} job_ctl records", acks.size());
+    return job_ctl::encodeAcks(acks);
+}
+
+void JobRegistry::startJobCtl() {
+    std::string path;
+    try {
+        path = Config::instance().getString("collectors_config", "job_ctl_socket");
+    } catch (const std::exception& e) {
+        spdlog::debug("JobRegistry: collectors_config.job_ctl_socket not set, socket endpoint disabled");
+        return;
+    }
+
+    unsigned mode = 0;
+    try {
+        mode = static_cast<unsigned>(std::stoul(Config::instance().getString("collectors_config", "job_ctl_socket_mode"), nullptr, 8));
+    } catch (const std::exception& e) {
+        spdlog::debug("JobRegistry: collectors_config.job_ctl_socket_mode not set, follow umask");
+    }
+
+    /* 能登记作业就能让任意进程的数据被导出，默认只接受 root 与本进程的用户 */
+    std::vector<int> uids{0, static_cast<int>(::geteuid())}, gids;
+    try {
+        auto extra = Config::instance().getArray<int>("collectors_config", "job_ctl_allowed_uids");
+        uids.insert(uids.end(), extra.begin(), extra.end());
+    } catch (const std::exception& e) {
+        spdlog::debug("JobRegistry: collectors_config.job_ctl_allowed_uids not set");
+    }
+    try {
+        gids = Config::instance().getArray<int>("collectors_config", "job_ctl_allowed_gids");
+    } catch (const std::exception& e) {
+        spdlog::debug("JobRegistry: collectors_config.job_ctl_allowed_gids not set");
+    }
+
+    try {
+        job_ctl_.emplace(StreamWatcher::Config{
+            .type = StreamWatcher::Type::UNIX,
+            .path = path,
+            .mode = mode,
+            .authorize = [uids, gids](uid_t uid, gid_t gid) {
+                return std::find(uids.begin(), uids.end(), static_cast<int>(uid)) != uids.end() ||
+                       std::find(gids.begin(), gids.end(), static_cast<int>(gid)) != gids.end();
+            }
+            },
+            StreamWatcher::RequestCallback([this](const char* buf, std::size_t len) { return onJobCtl(buf, len); }));
+        job_ctl_->start();
+    } catch (const std::exception& e) {
+        spdlog::warn("JobRegistry: failed to listen on job_ctl socket {}: {}", path, e.what());
+        job_ctl_.reset();
+    }
+}
 
 JobRegistry::JobRegistry(){
+        /* 先确定进程跟踪方式：作业控制入口的线程一启动就可能登记作业，会读取 pid_watcher_ / proc_events_ */
+        std::string tracking = "scan";
+        try {
+            tracking = Config::instance().getString("lens_config", "proc_tracking");
+        } catch (const std::exception& e) {
+            spdlog::debug("JobRegistry: lens_config.proc_tracking not set, use scan");
+        }
+        if (tracking == "netlink") startProcEvents();
+        if (!eventTracking()) startPidWatcher();
+
         job_opt_.emplace(StreamWatcher::Config{
             .type = StreamWatcher::Type::FIFO,
-            .path = Config::instance().getString("collectors_config", "job_adder_fifo")
+            .path = Config::instance().getString("collectors_config", "job_adder_fifo"),
+            .framing = StreamWatcher::Framing::Line,
+            .mode = 0,
+            .authorize = nullptr
             },
-            [this](const char* buf, std::size_t len) {
-                Job job;
-                std::string opt;
-                try
-                {
-                    opt = string2JobOpt(std::string(buf, len), job);
-                }
-                catch(const std::exception& e)
-                {
-                    spdlog::error("JobRegistry: job_opt parse error: {}",e.what());
-                    return;
-                }
-                
-                if(opt.compare("add") == 0){
-                    addJob(job);
-                }
-                if(opt.compare("remove") == 0){
-                    delJob(job.JobID);
-                }
-        });
+            [this](const char* buf, std::size_t len) { onJobOpt(buf, len); });
         job_opt_->start();
+        startJobCtl();
     };
 
 JobRegistry& JobRegistry::instance() {
@@ -71,78 +263,407 @@ JobRegistry& JobRegistry::instance() {
     return reg;
 }
 
+template <typename Fn>
+void JobRegistry::update(Fn&& fn) {
+    auto next = std::make_shared<JobMap>(*std::atomic_load(&jobs_));
+    fn(*next);
+    std::atomic_store(&jobs_, std::shared_ptr<const JobMap>(std::move(next)));
+}
+
 void JobRegistry::addJob(Job job) {
+    std::vector<JobOp> ops;
+    ops.push_back({JobOp::Kind::Add, std::move(job)});
+    applyOps(ops);
+}
+
+void JobRegistry::delJob(int jobID) {
+    std::vector<JobOp> ops;
+    Job job;
+    job.JobID = jobID;
+    ops.push_back({JobOp::Kind::Remove, std::move(job)});
+    applyOps(ops);
+}
+
+void JobRegistry::applyOps(std::vector<JobOp>& ops) {
+    if (ops.empty()) return;
+
+    struct applied {
+        JobOp::Kind      kind;
+        JobPtr           job;
+        std::vector<int> released;   // Remove：交还的 PID
+    };
+    std::vector<applied> done;
+    done.reserve(ops.size());
     {
         std::unique_lock lg(mtx_);
-        if (jobs_.count(job.JobID)) {
-            spdlog::warn("JobRegistry: duplicate jobID {}, ignored", job.JobID);
-            return;
+        update([&](JobMap& next) {
+            for (auto& op : ops) {
+                int jobID = op.job.JobID;
+                if (op.kind == JobOp::Kind::Add) {
+                    if (next.count(jobID)) {
+                        spdlog::warn("JobRegistry: duplicate jobID {}, ignored", jobID);
+                        op.result = OpResult::Duplicate;
+                        continue;
+                    }
+                    auto added = std::make_shared<const Job>(std::move(op.job));
+                    for (int pid : added->JobPIDs) addOwner(pid, jobID);
+                    next.emplace(jobID, added);
+                    events_.push_back({JobEvent::Added, added});
+                    done.push_back({op.kind, std::move(added), {}});
+                } else {
+                    auto it = next.find(jobID);
+                    if (it == next.end()) {
+                        op.result = OpResult::NotFound;
+                        continue;
+                    }
+                    applied r{op.kind, it->second, {}};
+                    next.erase(it);
+                    pid_deltas_.erase(jobID);   // 尚未发布的进程变更随作业一起作废
+                    for (int pid : r.job->JobPIDs)
+                        if (dropOwner(pid, jobID)) r.released.push_back(pid);
+                    events_.push_back({JobEvent::Removed, r.job});
+                    done.push_back(std::move(r));
+                }
+            }
+        });
+    }
+
+    /* 先投递回调再开始监视退出：pidfd 线程发出的 Removed 只会排在 Added 之后 */
+    deliverEvents();
+
+    /* 整批新作业共用一次 /proc 扫描补齐后代 */
+    if (eventTracking()) {
+        std::vector<int> addedIDs;
+        for (const auto& r : done)
+            if (r.kind == JobOp::Kind::Add) addedIDs.push_back(r.job->JobID);
+        seedDescendants(addedIDs);
+    }
+
+    /* 登记时就已退出的 PID 拿不到 pidfd，整批处理完后按退出处理 */
+    std::vector<int> exited;
+    for (const auto& r : done) {
+        if (r.kind == JobOp::Kind::Add) {
+            if (pid_watcher_) {
+                for (int pid : r.job->JobPIDs)
+                    if (pid_watcher_->watch(pid) == PidWatcher::Watch::Exited) exited.push_back(pid);
+            }
+            spdlog::info("JobRegistry: add job with JobID {}", r.job->JobID);
+        } else {
+            if (pid_watcher_)
+                for (int pid : r.released) pid_watcher_->unwatch(pid);
+            spdlog::info("JobRegistry: remove job with JobID {}, {} PIDs", r.job->JobID, r.job->JobPIDs.size());
         }
-        jobs_.emplace(job.JobID, std::move(job));
     }
-    for (const auto& cb : cbs_) cb(JobEvent::Added, jobs_.at(job.JobID));
-    spdlog::info("JobRegistry: add job with JobID {}", job.JobID);
+    for (int pid : exited) onPidExit(pid);
 }
 
-void JobRegistry::delJob(int jobID) {
-    Job removed;                // 先拷贝出来，再回调，避免锁内回调
+void JobRegistry::deliverEvents() {
+    /* 回调内再次增删作业时事件已入队，由外层的循环接着投递，避免重入 cb_mtx_ */
+    thread_local bool delivering = false;
+    if (delivering) return;
+    std::lock_guard dl(cb_mtx_);
+    delivering = true;
+    struct reset { bool& flag; ~reset() { flag = false; } } guard{delivering};
+    for (;;) {
+        lifecycle_event e;
+        {
+            std::unique_lock lg(mtx_);
+            if (events_.empty()) return;
+            e = std::move(events_.front());
+            events_.pop_front();
+        }
+        for (const auto& cb : cbs_) cb(e.event, *e.job);
+    }
+}
+
+bool JobRegistry::addOwner(int pid, int jobID) {
+    auto& owners = pid_owner_[pid];
+    if (std::find(owners.begin(), owners.end(), jobID) != owners.end()) return false;
+    owners.push_back(jobID);
+    return true;
+}
+
+bool JobRegistry::dropOwner(int pid, int jobID) {
+    auto it = pid_owner_.find(pid);
+    if (it == pid_owner_.end()) return false;
+    auto& owners = it->second;
+    auto pos = std::find(owners.begin(), owners.end(), jobID);
+    if (pos == owners.end()) return false;
+    owners.erase(pos);
+    if (!owners.empty()) return false;   // 仍属于其他作业，继续监视
+    pid_owner_.erase(it);
+    anchors_.erase(pid);
+    return true;
+}
+
+JobRegistry::OpResult JobRegistry::updateJob(const JobUpdate& u) {
+    flushPidChanges();   // 先让挂起的 fork / exit 落地，按最新的进程集合修改
+    JobPtr updated;
+    std::vector<int> added, removed, released;
     {
         std::unique_lock lg(mtx_);
-        auto it = jobs_.find(jobID);
-        if (it == jobs_.end()) return;
-        removed = std::move(it->second);
-        jobs_.erase(it);
+        auto jobs = std::atomic_load(&jobs_);
+        auto it = jobs->find(u.JobID);
+        if (it == jobs->end()) return OpResult::NotFound;
+        auto job = std::make_shared<Job>(*it->second);
+
+        switch (u.mode) {
+            case JobUpdate::Mode::Replace:
+                if (u.JobPIDs) {
+                    const auto& want = *u.JobPIDs;
+                    for (int pid : job->JobPIDs)
+                        if (std::find(want.begin(), want.end(), pid) == want.end()) removed.push_back(pid);
+                    for (int pid : want)
+                        if (std::find(job->JobPIDs.begin(), job->JobPIDs.end(), pid) == job->JobPIDs.end()) added.push_back(pid);
+                    job->JobPIDs = want;
+                }
+                if (u.CollectorNames) job->CollectorNames = *u.CollectorNames;
+                if (u.SampleFreq) job->SampleFreq = *u.SampleFreq;
+                break;
+            case JobUpdate::Mode::Attach:
+                if (u.JobPIDs) added = mergeInto(job->JobPIDs, *u.JobPIDs);
+                if (u.CollectorNames) mergeInto(job->CollectorNames, *u.CollectorNames);
+                break;
+            case JobUpdate::Mode::Detach:
+                if (u.JobPIDs) removed = removeFrom(job->JobPIDs, *u.JobPIDs);
+                if (u.CollectorNames) removeFrom(job->CollectorNames, *u.CollectorNames);
+                break;
+        }
+
+        for (int pid : added) addOwner(pid, u.JobID);
+        for (int pid : removed)
+            if (dropOwner(pid, u.JobID)) released.push_back(pid);
+        updated = job;
+        update([&](JobMap& next) { next[u.JobID] = std::move(job); });
+        if (!updated->JobPIDs.empty()) events_.push_back({JobEvent::Updated, updated});
+    }
+
+    if (updated->JobPIDs.empty()) {
+        spdlog::info("JobRegistry: job {} has no PID left after update, delete it", u.JobID);
+        /* 已从 pid_owner_ 摘掉的 PID 不在 delJob 的释放范围内，这里先停止监视 */
+        if (pid_watcher_)
+            for (int pid : released) pid_watcher_->unwatch(pid);
+        delJob(u.JobID);
+        return OpResult::Applied;
     }
-    for (const auto& cb : cbs_) cb(JobEvent::Removed, removed);
-    spdlog::info("JobRegistry: remove job with JobID {}, JobPIDs {}", removed.JobID);
+
+    deliverEvents();
+
+    std::vector<int> exited;
+    if (pid_watcher_) {
+        for (int pid : released) pid_watcher_->unwatch(pid);
+        for (int pid : added)
+            if (pid_watcher_->watch(pid) == PidWatcher::Watch::Exited) exited.push_back(pid);
+    }
+    /* 事件模式下整体替换会丢掉已挂载的后代，重新从新的根 PID 补齐 */
+    if (eventTracking() && (!added.empty() || !removed.empty())) seedDescendants({u.JobID});
+    spdlog::info("JobRegistry: update job {}, +{} -{} PIDs, {} collectors", u.JobID, added.size(), removed.size(),
+                 updated->CollectorNames.size());
+    for (int pid : exited) onPidExit(pid);
+    return OpResult::Applied;
 }
 
 inline bool is_process_running(pid_t pid) {
     return kill(pid, 0) == 0;
 }
 
-const Job* JobRegistry::findJob(int jobID) const
+JobPtr JobRegistry::findJob(int jobID) const
 {
-    std::vector<int> toDelete;          
-    const Job* ret = nullptr;
+    auto jobs = std::atomic_load(&jobs_);
+    auto it = jobs->find(jobID);
+    return it == jobs->end() ? nullptr : it->second;
+}
 
-    {
-        std::shared_lock lg(mtx_);
-        auto it = jobs_.find(jobID);
-        if (it == jobs_.end()) return nullptr;
+std::shared_ptr<const JobRegistry::JobMap> JobRegistry::snapshot() const {
+    return std::atomic_load(&jobs_);
+}
 
-        Job job = it->second;  
+void JobRegistry::reapExited() {
+    /* 事件模式下退出的 PID 已被实时摘除，无需逐个探测 */
+    if (eventTracking()) return;
 
-        // 过滤 PID
-        job.JobPIDs.erase(
-            std::remove_if(job.JobPIDs.begin(),
-                           job.JobPIDs.end(),
-                           [](pid_t pid){ return !is_process_running(pid); }),
-            job.JobPIDs.end());
+    auto jobs = snapshot();   // 循环中会删除作业并发布新表，先持有当前这份
+    for (const auto& [jobID, job] : *jobs) {
+        /* 监视中的 PID 一定存活（退出时已被摘除），不必再发系统调用；保留作锚点的 PID 已确认退出，
+           不能再用 kill 探测（PID 可能已被复用）；只有没能拿到 pidfd 的（fd 耗尽等）仍用 kill 探测 */
+        bool alive = std::any_of(job->JobPIDs.begin(), job->JobPIDs.end(), [this](pid_t pid){
+            if (pid_watcher_ && pid_watcher_->watching(pid)) return true;
+            {
+                std::shared_lock lg(mtx_);
+                if (anchors_.count(pid)) return false;
+            }
+            return is_process_running(pid);
+        });
 
-        if (job.JobPIDs.empty()) {
-            toDelete.push_back(jobID);   
-            spdlog::info("JobRegistry: job {} has no running process, delete it", job.JobID);
+        /* 根进程都已退出，但后代仍在运行（如包装脚本先退出）时，作业仍然存活 */
+        if (!alive && !ProcessTree::instance().hasLiveDescendant(job->JobPIDs)) {
+            spdlog::info("JobRegistry: job {} has no running process, delete it", jobID);
+            delJob(jobID);
         }
-        ret = &it->second;
-    }  
+    }
+}
+
+void JobRegistry::startProcEvents() {
+    proc_events_.emplace(ProcEventSource::Handlers{
+        .onFork = [this](int parent, int child) { recordAttach(parent, child); },
+        .onExec = nullptr,
+        .onExit = [this](int pid) { recordDetach(pid); },
+        .onLost = [this]() { resync(); },
+        /* fork / exit 只记录变更，一批事件处理完再合并成一次发布 */
+        .onDrained = [this]() { flushPidChanges(); },
+    });
+    if (!proc_events_->start()) {
+        spdlog::warn("JobRegistry: proc connector unavailable, fall back to scanning /proc");
+        proc_events_.reset();
+    }
+}
 
-    for (int id : toDelete)
-        const_cast<JobRegistry*>(this)->delJob(id);   // 非 const 调用
+void JobRegistry::startPidWatcher() {
+    pid_watcher_.emplace([this](int pid) { onPidExit(pid); });
+    if (!pid_watcher_->start()) {
+        spdlog::warn("JobRegistry: pidfd unavailable, fall back to probing job processes periodically");
+        pid_watcher_.reset();
+    }
+}
 
-    return toDelete.empty() ? ret : nullptr;   // 如果删了，就返回空
+/* 根进程退出但后代仍在运行（如包装脚本先退出）时，保留它作为展开进程树的锚点并记入 anchors_，
+   此后按已退出处理而不再探测；等后代全部退出后由 reapExited() 移除作业 */
+void JobRegistry::onPidExit(int pid) {
+    if (ProcessTree::instance().hasLiveDescendant({pid})) {
+        spdlog::debug("JobRegistry: pid {} exited, descendants still running", pid);
+        std::unique_lock lg(mtx_);
+        if (pid_owner_.count(pid)) anchors_.insert(pid);
+        return;
+    }
+    detachPid(pid);
 }
 
+void JobRegistry::attachPid(int parentPid, int childPid) {
+    if (recordAttach(parentPid, childPid)) flushPidChanges();
+}
 
-std::vector<Job> JobRegistry::snapshot() const {
-    std::shared_lock lg(mtx_);
-    std::vector<Job> out;
-    out.reserve(jobs_.size());
-    for (const auto& [id, job] : jobs_) out.push_back(job);
-    return out;
+void JobRegistry::detachPid(int pid) {
+    if (recordDetach(pid)) flushPidChanges();
 }
 
-void JobRegistry::addLifecycleCb(JobLifecycleCb cb) {
+bool JobRegistry::recordAttach(int parentPid, int childPid) {
+    {
+        std::shared_lock lg(mtx_);
+        if (!pid_owner_.count(parentPid)) return false;   // 绝大多数 fork 与作业无关
+    }
+    std::unique_lock lg(mtx_);
+    auto owner = pid_owner_.find(parentPid);
+    if (owner == pid_owner_.end()) return false;
+    /* 父进程同属多个作业时，子进程也挂到每个作业下 */
+    std::vector<int> jobIDs = owner->second;
+    bool changed = false;
+    for (int jobID : jobIDs) {
+        if (!addOwner(childPid, jobID)) continue;
+        auto& d = pid_deltas_[jobID];
+        auto gone = std::find(d.removed.begin(), d.removed.end(), childPid);
+        if (gone != d.removed.end()) d.removed.erase(gone);
+        else d.added.push_back(childPid);
+        changed = true;
+        spdlog::trace("JobRegistry: attach pid {} (parent {}) to job {}", childPid, parentPid, jobID);
+    }
+    return changed;
+}
+
+bool JobRegistry::recordDetach(int pid) {
+    {
+        std::shared_lock lg(mtx_);
+        if (!pid_owner_.count(pid)) return false;
+    }
     std::unique_lock lg(mtx_);
+    auto owner = pid_owner_.find(pid);
+    if (owner == pid_owner_.end()) return false;
+    std::vector<int> jobIDs = std::move(owner->second);
+    pid_owner_.erase(owner);
+    anchors_.erase(pid);
+    for (int jobID : jobIDs) {
+        /* 同一批内先 fork 后退出的进程直接抵消，不必出现在发布的表里 */
+        auto& d = pid_deltas_[jobID];
+        auto born = std::find(d.added.begin(), d.added.end(), pid);
+        if (born != d.added.end()) d.added.erase(born);
+        else d.removed.push_back(pid);
+        spdlog::trace("JobRegistry: detach exited pid {} from job {}", pid, jobID);
+    }
+    return true;
+}
+
+void JobRegistry::flushPidChanges() {
+    std::vector<int> emptied;
+    {
+        std::unique_lock lg(mtx_);
+        if (pid_deltas_.empty()) return;
+        update([&](JobMap& next) {
+            for (const auto& [jobID, d] : pid_deltas_) {
+                if (d.added.empty() && d.removed.empty()) continue;
+                auto it = next.find(jobID);
+                if (it == next.end()) continue;
+                auto job = std::make_shared<Job>(*it->second);
+                auto& pids = job->JobPIDs;
+                for (int pid : d.added)
+                    if (std::find(pids.begin(), pids.end(), pid) == pids.end()) pids.push_back(pid);
+                for (int pid : d.removed)
+                    pids.erase(std::remove(pids.begin(), pids.end(), pid), pids.end());
+                if (pids.empty()) emptied.push_back(jobID);
+                it->second = std::move(job);
+            }
+        });
+        pid_deltas_.clear();
+    }
+    for (int jobID : emptied) {
+        spdlog::info("JobRegistry: last process of job {} exited, delete it", jobID);
+        delJob(jobID);
+    }
+}
+
+/* 作业登记之前就已存在的后代进程不会产生 fork 事件，登记时扫描一次 /proc 补齐。
+   一批作业只刷新一次进程树，再逐个展开 */
+void JobRegistry::seedDescendants(const std::vector<int>& jobIDs) {
+    if (jobIDs.empty()) return;
+    ProcessTree::instance().refresh(std::chrono::steady_clock::duration::zero());
+    std::vector<std::pair<int, std::vector<int>>> trees;
+    trees.reserve(jobIDs.size());
+    for (int jobID : jobIDs) {
+        auto found = findJob(jobID);
+        if (found) trees.emplace_back(jobID, ProcessTree::instance().expand(found->JobPIDs));
+    }
+
+    {
+        std::unique_lock lg(mtx_);
+        auto jobs = std::atomic_load(&jobs_);
+        for (const auto& [jobID, tree] : trees) {
+            if (!jobs->count(jobID)) continue;
+            for (int pid : tree) {
+                if (!addOwner(pid, jobID)) continue;
+                auto& d = pid_deltas_[jobID];
+                auto gone = std::find(d.removed.begin(), d.removed.end(), pid);
+                if (gone != d.removed.end()) d.removed.erase(gone);
+                else d.added.push_back(pid);
+            }
+        }
+    }
+    flushPidChanges();
+}
+
+/* 事件丢失后的全量校正：摘除已退出的 PID，补齐遗漏的后代 */
+void JobRegistry::resync() {
+    flushPidChanges();
+    std::vector<int> ids, dead;
+    auto jobs = snapshot();
+    for (const auto& [id, job] : *jobs) ids.push_back(id);
+    {
+        std::shared_lock lg(mtx_);
+        for (const auto& [pid, owners] : pid_owner_)
+            if (!is_process_running(pid)) dead.push_back(pid);
+    }
+    for (int pid : dead) detachPid(pid);
+    seedDescendants(ids);
+}
+
+void JobRegistry::addLifecycleCb(JobLifecycleCb cb) {
+    std::lock_guard lg(cb_mtx_);
     cbs_.push_back(std::move(cb));
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "collector/pid_watcher.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <spdlog/spdlog.h>
+
+/* 较老的 glibc 没有 pidfd_open 的封装与调用号 */
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+namespace {
+
+int pidfdOpen(int pid) {
+    return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+}
+
+/* epoll 事件里同时带上 PID 与 fd：同一 PID 先摘除再重新监视时，旧 fd 的迟到事件可以识别出来 */
+std::uint64_t pack(int pid, int fd) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(pid)) << 32) | static_cast<std::uint32_t>(fd);
+}
+
+} // namespace
+
+PidWatcher::PidWatcher(std::function<void(int pid)> onExit) : onExit_(std::move(onExit)) {}
+
+PidWatcher::~PidWatcher() { stop(); }
+
+bool PidWatcher::start() {
+    if (epfd_ >= 0) return true;
+
+    int probe = pidfdOpen(::getpid());
+    if (probe < 0) {
+        spdlog::warn("PidWatcher: pidfd_open unavailable: {}", strerror(errno));
+        return false;
+    }
+    ::close(probe);
+
+    epfd_   = ::epoll_create1(EPOLL_CLOEXEC);
+    wakefd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event ev{};
+    ev.events   = EPOLLIN;
+    ev.data.u64 = pack(-1, wakefd_);
+    if (epfd_ < 0 || wakefd_ < 0 || ::epoll_ctl(epfd_, EPOLL_CTL_ADD, wakefd_, &ev) < 0) {
+        spdlog::warn("PidWatcher: epoll setup failed: {}", strerror(errno));
+        if (epfd_ >= 0) ::close(epfd_);
+        if (wakefd_ >= 0) ::close(wakefd_);
+        epfd_ = wakefd_ = -1;
+        return false;
+    }
+
+    stop_flag_ = false;
+    thread_ = std::thread([this] { loop(); });
+    spdlog::info("PidWatcher: watching process exits with pidfd");
+    return true;
+}
+
+void PidWatcher::stop() {
+    stop_flag_ = true;
+    if (wakefd_ >= 0) {
+        std::uint64_t one = 1;
+        ssize_t n = ::write(wakefd_, &one, sizeof(one));
+        (void)n;
+    }
+    if (thread_.joinable()) thread_.join();
+
+    std::lock_guard lg(m_);
+    for (const auto& [pid, fd] : fds_) ::close(fd);
+    fds_.clear();
+    if (epfd_ >= 0) ::close(epfd_);
+    if (wakefd_ >= 0) ::close(wakefd_);
+    epfd_ = wakefd_ = -1;
+}
+
+PidWatcher::Watch PidWatcher::watch(int pid) {
+    if (pid <= 0) return Watch::Exited;
+    std::lock_guard lg(m_);
+    if (epfd_ < 0) return Watch::Failed;
+    if (fds_.count(pid)) return Watch::Watching;
+
+    int fd = pidfdOpen(pid);
+    if (fd < 0) {
+        if (errno == ESRCH) return Watch::Exited;
+        spdlog::warn("PidWatcher: pidfd_open({}) failed: {}", pid, strerror(errno));
+        return Watch::Failed;
+    }
+    epoll_event ev{};
+    ev.events   = EPOLLIN;
+    ev.data.u64 = pack(pid, fd);
+    if (::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        spdlog::warn("PidWatcher: epoll_ctl add pid {} failed: {}", pid, strerror(errno));
+        ::close(fd);
+        return Watch::Failed;
+    }
+    fds_.emplace(pid, fd);
+    return Watch::Watching;
+}
+
+void PidWatcher::unwatch(int pid) {
+    std::lock_guard lg(m_);
+    auto it = fds_.find(pid);
+    if (it == fds_.end()) return;
+    ::epoll_ctl(epfd_, EPOLL_CTL_DEL, it->second, nullptr);
+    ::close(it->second);
+    fds_.erase(it);
+}
+
+bool PidWatcher::watching(int pid) const {
+    std::lock_guard lg(m_);
+    return fds_.count(pid) != 0;
+}
+
+std::size_t PidWatcher::size() const {
+    std::lock_guard lg(m_);
+    return fds_.size();
+}
+
+void PidWatcher::loop() {
+    epoll_event evs[64];
+    while (!stop_flag_) {
+        int n = ::epoll_wait(epfd_, evs, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            spdlog::error("PidWatcher: epoll_wait failed: {}", strerror(errno));
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int pid = static_cast<int>(static_cast<std::int32_t>(evs[i].data.u64 >> 32));
+            int fd  = static_cast<int>(static_cast<std::uint32_t>(evs[i].data.u64));
+            if (pid < 0) continue;   // 唤醒事件，回到循环检查停止标志
+            {
+                std::lock_guard lg(m_);
+                auto it = fds_.find(pid);
+                if (it == fds_.end() || it->second != fd) continue;   // 已被摘除
+                /* fd 号可能已被重新监视的同一 PID 复用，确认进程确实已退出 */
+                pollfd p{fd, POLLIN, 0};
+                if (::poll(&p, 1, 0) <= 0) continue;
+                ::epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+                ::close(fd);
+                fds_.erase(it);
+            }
+            spdlog::trace("PidWatcher: pid {} exited", pid);
+            if (onExit_) onExit_(pid);
+        }
+    }
+}
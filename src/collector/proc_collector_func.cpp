@@ -2,7 +2,6 @@
 #include <fmt/core.h>
 #include <fstream>
 #include <sstream>
-#include <filesystem>
 #include <unistd.h>
 #include <dirent.h>
 #include <limits>
@@ -11,10 +10,15 @@
 #include <list>
 #include <stdexcept>
 #include <optional>
+#include <cstdio>
+#include <cerrno>
+#include <sys/resource.h>
+#include <fcntl.h>
 
 
 #include "collector/collector_type.h"
 #include "collector/collector_registry.hpp"
+#include "collector/procfs_reader.hpp"
 #include <any>
 #include <iostream>
 #include <fmt/chrono.h>
@@ -23,233 +27,282 @@
 namespace proc_collector {
 
 
-/* 获取系统总内存（单位：KB），失败返回 nullopt */
-std::optional<std::size_t> getMemTotalKb();
-
-/* 对单个进程采集一次快照 */
-std::unique_ptr<proc_info> snapshotOf(int pid);
-
-
-
 /* ---------- 内部工具 ---------- */
 static std::size_t pageSize() {
     static const std::size_t sz = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
     return sz;
 }
 
-/* ---------- 公开接口 ---------- */
-std::optional<std::size_t> getMemTotalKb() {
-    std::ifstream f("/proc/meminfo");
-    std::string line;
-    while (std::getline(f, line)) {
-        if (line.compare(0, 9, "MemTotal:") == 0) {
-            std::size_t kb;
-            std::istringstream iss(line);
-            std::string _;
-            iss >> _ >> kb;
-            return kb;
-        }
-    }
-    return std::nullopt;
+/* 把 /proc/<pid>/<name> 读入每线程缓冲区，返回读到的字节数，失败返回 -1 */
+static ssize_t readPidFile(int pid, const char* name) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+    return procfs::read_file(path, procfs::thread_buffer(), procfs::kReadBufSize);
 }
 
-std::unique_ptr<proc_info> ProcCollector::snapshotOf(int pid) {
-    try {
-        auto info = std::make_unique<proc_info>();
-        info->pid = pid;
+void proc_info::clear() {
+    pid = ppid = 0;
+    name.clear();
+    cpuPercent = 0.0;
+    utime = stime = starttime = 0;
+    hz = numCores = 0;
+    memoryRss = 0;
+    memoryPercent = 0.0;
+    numThreads = 0;
+    ioReadCount = ioWriteCount = 0;
+    netConnCount = fdCount = pipeCount = fileCount = anonInodeCount = 0;
+    status.assign("unknown");
+    threads.clear();
+}
 
-        /* 1. /proc/<pid>/stat ------------------------------------------------- */
-        {
-            std::ifstream f(fmt::format("/proc/{}/stat", pid));
-            if (!f) return nullptr;
-
-            std::string line;
-            std::getline(f, line);
-            std::istringstream iss(line);
-
-            int _pid;
-            iss >> _pid;
-            if (iss.peek() == ' ') iss.ignore();   // 去掉空格
-            if (iss.peek() == '(') {               // 进程名可能带空格
-                iss.ignore();
-                std::getline(iss, info->name, ')');
-            } else {
-                iss >> info->name;
-            }
+const Schema& procSchema() {
+    using namespace thread_cols;
+    static const Schema threads("thread", -1, {
+        Schema::column(kTid), Schema::column(kName), Schema::column(kState), Schema::column(kProcessor),
+        Schema::column(thread_cols::kCpuPercent), Schema::column(kUtime), Schema::column(kStime),
+    });
+    using namespace proc_cols;
+    static const Schema schema = Schema("proc", int8_t(CollectorType::ProcCollector), {
+        Schema::column(kPid), Schema::column(proc_cols::kName), Schema::column(kPpid),
+        Schema::column(proc_cols::kCpuPercent), Schema::column(kCpuTimeSec), Schema::column(kMemoryRss),
+        Schema::column(kMemoryPercent), Schema::column(kNumThreads), Schema::column(kIoReadCount),
+        Schema::column(kIoWriteCount), Schema::column(kNetConnCount), Schema::column(kFdCount),
+        Schema::column(kPipeCount), Schema::column(kFileCount), Schema::column(kAnonInodeCount),
+        Schema::column(kStatus), Schema::column(kStarttime), Schema::column(kIoReadRate),
+        Schema::column(kIoWriteRate),
+    }, &threads, "threads").withRates(Schema::rates(kPid, kStarttime, {
+        Schema::counter(kIoReadCount, kIoReadRate), Schema::counter(kIoWriteCount, kIoWriteRate),
+    }));
+    return schema;
+}
 
-            char state;
-            iss >> state >> info->ppid;            // 第 2 列 state，第 3 列 ppid
+bool ProcCollector::snapshotOf(int pid, const HostSnapshot& host, proc_info& info) {
+    auto& s = shardOf(pid);
+    std::lock_guard lg(s.m);
+    try {
+        info.clear();
+        info.pid = pid;
+        char* buf = procfs::thread_buffer();
+        ssize_t n = 0;
 
-            /* 跳到第 14 列（utime） */
-            unsigned long long utime, stime;
-            for (int i = 0; i < 11; ++i)
-                iss.ignore(std::numeric_limits<std::streamsize>::max(), ' ');
-            iss >> utime >> stime;                 // 14,15
+        /* 优先使用缓存的 /proc/<pid> 句柄；缓存已满时回退到一次性 open/close */
+        procfs::PidHandle* h = s.handle_cache.acquire(pid);
+        auto readFile = [&](procfs::PidFile f, const char* name) -> ssize_t {
+            return h ? h->read(f, buf, procfs::kReadBufSize) : readPidFile(pid, name);
+        };
 
-            unsigned long long starttime;
-            for (int i = 0; i < 4; ++i)
-                iss.ignore(std::numeric_limits<std::streamsize>::max(), ' ');
-            iss >> starttime;                      // 22
+        /* 1. /proc/<pid>/stat ------------------------------------------------- */
+        procfs::StatFields stat;
+        n = readFile(procfs::PidFile::Stat, "stat");
+        if (n <= 0 || !procfs::parse_stat(buf, static_cast<std::size_t>(n), stat)) {
+            s.handle_cache.invalidate(pid);   // 进程已退出，旧句柄作废
+            return false;
         }
+        if (h) {
+            if (h->starttime == 0) {
+                h->starttime = stat.starttime;
+            } else if (h->starttime != stat.starttime) {
+                s.handle_cache.invalidate(pid);   // PID 已被复用
+                return false;
+            }
+        }
+        info.name.assign(stat.comm, stat.comm_len);   // comm 不超过 15 字节，走 SSO 不分配
+        info.ppid      = stat.ppid;
+        info.utime     = stat.utime;
+        info.stime     = stat.stime;
+        info.starttime = stat.starttime;
 
         /* 2. /proc/<pid>/statm ----------------------------------------------- */
-        {
-            std::ifstream f(fmt::format("/proc/{}/statm", pid));
-            if (f) {
-                unsigned long vmsize, rss;
-                f >> vmsize >> rss;
-                info->memoryRss = rss * pageSize();
-            }
+        n = readFile(procfs::PidFile::Statm, "statm");
+        if (n > 0) {
+            procfs::StatmFields statm;
+            if (procfs::parse_statm(buf, static_cast<std::size_t>(n), statm))
+                info.memoryRss = statm.resident_pages * pageSize();
         }
 
         /* 3. /proc/<pid>/status ---------------------------------------------- */
+        n = readFile(procfs::PidFile::Status, "status");
+        if (n <= 0) return false;
         {
-            std::ifstream f(fmt::format("/proc/{}/status", pid));
-            if (!f) return nullptr;
-
-            std::string line;
-            while (std::getline(f, line)) {
-                if (line.compare(0, 6, "VmRSS:") == 0) {
-                    std::istringstream iss(line);
-                    std::string _;
-                    std::size_t kb;
-                    iss >> _ >> kb;
-                    if (auto totalKb = getMemTotalKb())
-                        info->memoryPercent = 100.0 * kb / *totalKb;
-                } else if (line.compare(0,8,"Threads:") == 0) {
-                    std::istringstream iss(line);
-                    std::string _;
-                    iss >> _ >> info->numThreads;
-                }
-            }
+            procfs::StatusFields status;
+            procfs::parse_status(buf, static_cast<std::size_t>(n), status);
+            info.numThreads = static_cast<int>(status.threads);
+            if (status.vm_rss_kb > 0 && host.memTotalKb > 0)
+                info.memoryPercent = 100.0 * status.vm_rss_kb / host.memTotalKb;
         }
 
         /* 4. /proc/<pid>/io ---------------------------------------------------- */
-        {
-            std::ifstream f(fmt::format("/proc/{}/io", pid));
-            std::string line;
-            while (std::getline(f, line)) {
-                if (line.compare(0,11,"read_bytes:") == 0) {
-                    std::istringstream iss(line);
-                    std::string _; std::size_t v;
-                    iss >> _ >> v;
-                    info->ioReadCount = static_cast<int>(v);
-                } else if (line.compare(0,12,"write_bytes:") == 0) {
-                    std::istringstream iss(line);
-                    std::string _; std::size_t v;
-                    iss >> _ >> v;
-                    info->ioWriteCount = static_cast<int>(v);
-                }
+        n = readFile(procfs::PidFile::Io, "io");
+        if (n > 0) {
+            procfs::IoFields io;
+            if (procfs::parse_io(buf, static_cast<std::size_t>(n), io)) {
+                info.ioReadCount  = io.read_bytes;
+                info.ioWriteCount = io.write_bytes;
             }
         }
 
-        /* 5. 网络 socket 计数 -------------------------------------------------- */
+        /* 5. fd 统计（socket / pipe / 文件 / anon inode） ------------------ */
         {
-            namespace fs = std::filesystem;
-            fs::path fd_dir = fmt::format("/proc/{}/fd", pid);
-            if (fs::exists(fd_dir)) {
-                for (const auto& entry : fs::directory_iterator(fd_dir)) {
-                    if (entry.is_symlink()) {
-                        std::string target = fs::read_symlink(entry.path()).string();
-                        if (target.compare(0,8,"socket:[") == 0)
-                            ++info->netConnCount;
-                    }
+            procfs::FdCensus census;
+            bool ok = false;
+            if (h) {
+                ok = h->fdCensus(census);
+            } else {
+                char path[32];
+                std::snprintf(path, sizeof(path), "/proc/%d/fd", pid);
+                int fd_dir = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (fd_dir >= 0) {
+                    ok = procfs::census_fds(fd_dir, nullptr, census);
+                    ::close(fd_dir);
                 }
             }
-        }
-                /* 6. /proc/<pid>/stat 中 CPU 时间 & 动态 CPU 使用率 --------------------- */
-        {
-            /* 注意：前面已经读过 /proc/<pid>/stat，但 istream 状态已失效，
-               这里重新打开一次，保证代码独立可拷贝 */
-            std::ifstream f(fmt::format("/proc/{}/stat", pid));
-            if (!f) return nullptr;
-
-            std::string line;
-            std::getline(f, line);
-            std::istringstream iss(line);
-
-            int _pid;
-            iss >> _pid;
-            if (iss.peek() == ' ') iss.ignore();
-            if (iss.peek() == '(') {
-                iss.ignore();
-                std::getline(iss, info->name, ')');
-            } else {
-                iss >> info->name;
+            if (ok) {
+                info.netConnCount   = static_cast<int>(census.sockets);
+                info.fdCount        = static_cast<int>(census.total);
+                info.pipeCount      = static_cast<int>(census.pipes);
+                info.fileCount      = static_cast<int>(census.files);
+                info.anonInodeCount = static_cast<int>(census.anonInodes);
             }
+        }
 
-            /* 跳过到第 14、15、22 列 */
-            unsigned long long utime = 0, stime = 0, starttime = 0;
-            for (int i = 0; i < 11; ++i)
-                iss.ignore(std::numeric_limits<std::streamsize>::max(), ' ');
-            iss >> utime >> stime;                 // 14,15
-            for (int i = 0; i < 4; ++i)
-                iss.ignore(std::numeric_limits<std::streamsize>::max(), ' ');
-            iss >> starttime;                      // 22
-
-            info->utime = utime;
-            info->stime = stime;
-            info->starttime = starttime;
-
-            /* ---- 计算 CPU 百分比 ---- */
-            info->hz = sysconf(_SC_CLK_TCK);      // 每秒 jiffies
-            info->numCores = sysconf(_SC_NPROCESSORS_ONLN);
-            if (info->hz > 0 && info->numCores > 0) {
-                auto cpuStat = []() -> unsigned long long {   // 取系统总 CPU 时间
-                    std::ifstream f("/proc/stat");
-                    std::string line;
-                    std::getline(f, line);
-                    std::istringstream iss(line);
-                    std::string _;
-                    unsigned long long v, sum = 0;
-                    iss >> _;                          
-                    while (iss >> v) sum += v;
-                    return sum;
-                };
-
-                unsigned long long currTotal = cpuStat();
-                unsigned long long currProc  = utime + stime;
-                auto& cu = pid_state_dict[pid];
-                std::cout<<"use pid:"<<pid<<std::endl;
-                unsigned long long deltaTotal = currTotal - cu.lastTotal;
-                unsigned long long deltaProc  = currProc  - cu.lastProc;
-                std::cout<<"currTotal="<<currTotal<<"   currProc="<<currProc<<std::endl;
-                std::cout<<"lastTotal="<<cu.lastTotal<<"   lastProc="<<cu.lastProc<<std::endl;
-                std::cout<<"deltaTotal="<<deltaTotal<<"   deltaProc="<<deltaProc<<std::endl;
-                if (deltaTotal > 0) {
-                    info->cpuPercent = 100.0 * double(deltaProc) / double(deltaTotal) * info->numCores;
-                } else {
-                    info->cpuPercent = 0.0;
-                }
+        /* 6. 动态 CPU 使用率（复用第 1 步解析出的 utime/stime） ----------------- */
+        /*    分母取本周期共享的整机快照，同一周期内所有 PID 一致 */
+        info.hz = host.hz;                   // 每秒 jiffies
+        info.numCores = host.numCores;
+        if (info.hz > 0 && info.numCores > 0) {
+            info.cpuPercent = cpuPercentOf(s.pid_state_dict[pid], stat.starttime, stat.utime + stat.stime, host);
+            spdlog::trace("ProcCollector: pid {} cpu={:.2f}%", pid, info.cpuPercent);
+        } else {
+            info.cpuPercent = 0.0;
+        }
 
-                /* 更新静态缓存（用于下一次采样） */
-                cu.lastTotal = currTotal;
-                cu.lastProc  = currProc;
-                std::cout<<"lastTotal="<<cu.lastTotal<<"   lastProc="<<cu.lastProc<<std::endl;
-            } else {
-                info->cpuPercent = 0.0;
-            }
+        /* 7. 逐线程采样（可选） ------------------------------------------------ */
+        if (per_thread_) {
+            if (h) snapshotThreads(s, *h, stat.num_threads, host, info);
+            else spdlog::trace("ProcCollector: pid {} has no cached handle, skip per-thread sample", pid);
         }
 
-        return info;
+        return true;
     } catch (...) {
-        return nullptr;
+        return false;
     }
 
 }
 
-std::any ProcCollector::impl_collect(const Job& job) {
-    std::vector<std::shared_ptr<proc_info>> infos;
-    auto time_start = std::chrono::system_clock::now();
+double ProcCollector::cpuPercentOf(pid_state& cu, unsigned long long starttime, unsigned long long currProc,
+                                   const HostSnapshot& host) {
+    if (cu.starttime != starttime) {   // 新进程/线程（或 ID 复用），重置基线
+        cu = pid_state{};
+        cu.starttime = starttime;
+    }
+    cu.lastSeen = std::chrono::steady_clock::now();
+    unsigned long long currTotal  = host.cpuTotal;
+    unsigned long long deltaTotal = currTotal - cu.lastTotal;
+    unsigned long long deltaProc  = currProc  - cu.lastProc;
+    if (deltaTotal == 0) {
+        /* 同一周期内再次采样同一 ID（属于多个作业），沿用本周期的结果 */
+        return cu.lastPercent;
+    }
+    cu.lastPercent = 100.0 * double(deltaProc) / double(deltaTotal) * host.numCores;
+    cu.lastTotal = currTotal;
+    cu.lastProc  = currProc;
+    return cu.lastPercent;
+}
+
+void ProcCollector::snapshotThreads(shard& s, procfs::PidHandle& h, std::int64_t num_threads,
+                                    const HostSnapshot& host, proc_info& info) {
+    thread_local std::vector<procfs::ThreadStat> stats;
+    if (!h.readThreads(num_threads, stats)) return;
+    info.threads.reserve(stats.size());
+    for (const auto& ts : stats) {
+        thread_info t;
+        t.tid       = ts.tid;
+        t.name.assign(ts.stat.comm, ts.stat.comm_len);
+        t.state     = ts.stat.state;
+        t.processor = ts.stat.processor;
+        t.utime     = ts.stat.utime;
+        t.stime     = ts.stat.stime;
+        if (info.hz > 0 && info.numCores > 0)
+            t.cpuPercent = cpuPercentOf(s.tid_state_dict[ts.tid], ts.stat.starttime, ts.stat.utime + ts.stat.stime, host);
+        info.threads.emplace_back(std::move(t));
+    }
+}
+
+void ProcCollector::sweepIdle() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_sweep_ < kIdleTimeout) return;
+    last_sweep_ = now;
+
+    rates_.sweep(kIdleTimeout);
+    for (auto& s : shards_) {
+        std::lock_guard lg(s.m);
+        s.handle_cache.sweep(kIdleTimeout);
+        for (auto* dict : {&s.pid_state_dict, &s.tid_state_dict}) {
+            for (auto it = dict->begin(); it != dict->end();) {
+                if (now - it->second.lastSeen > kIdleTimeout) it = dict->erase(it);
+                else ++it;
+            }
+        }
+    }
+}
+
+void ProcCollector::beginTick(const TickContext& ctx) {
+    std::atomic_store(&host_, ctx.host);
+    sweepIdle();
+}
+
+void ProcCollector::appendRow(SampleBatch& batch, const proc_info& info) {
+    using namespace proc_cols;
+    std::size_t r = batch.appendRow();
+    batch.set(r, kPid, info.pid);
+    batch.setInterned(r, proc_cols::kName, info.name);
+    batch.set(r, kPpid, info.ppid);
+    batch.set(r, proc_cols::kCpuPercent, info.cpuPercent);
+    if (info.hz > 0)
+        batch.set(r, kCpuTimeSec, static_cast<double>(info.utime + info.stime) / static_cast<double>(info.hz));
+    batch.set(r, kMemoryRss, info.memoryRss);
+    batch.set(r, kMemoryPercent, info.memoryPercent);
+    batch.set(r, kNumThreads, info.numThreads);
+    batch.set(r, kIoReadCount, info.ioReadCount);
+    batch.set(r, kIoWriteCount, info.ioWriteCount);
+    batch.set(r, kNetConnCount, info.netConnCount);
+    batch.set(r, kFdCount, info.fdCount);
+    batch.set(r, kPipeCount, info.pipeCount);
+    batch.set(r, kFileCount, info.fileCount);
+    batch.set(r, kAnonInodeCount, info.anonInodeCount);
+    batch.setInterned(r, kStatus, info.status);
+    batch.set(r, kStarttime, info.starttime);
+
+    if (info.threads.empty()) return;
+    SampleBatch& threads = *batch.child();
+    for (const auto& t : info.threads) {
+        using namespace thread_cols;
+        std::size_t tr = threads.appendRow();
+        threads.set(tr, kTid, t.tid);
+        threads.setInterned(tr, thread_cols::kName, t.name);
+        threads.setInterned(tr, kState, std::string_view(&t.state, 1));
+        threads.set(tr, kProcessor, t.processor);
+        threads.set(tr, thread_cols::kCpuPercent, t.cpuPercent);
+        threads.set(tr, kUtime, t.utime);
+        threads.set(tr, kStime, t.stime);
+    }
+}
+
+SampleBatchPtr ProcCollector::impl_collect(const Job& job) {
+    auto batch = std::make_shared<SampleBatch>(procSchema());
+    batch->reserve(job.JobPIDs.size());
+    /* 不经过采集周期直接调用时，临时取一次整机快照 */
+    auto host = std::atomic_load(&host_);
+    if (!host) host = std::make_shared<const HostSnapshot>(HostSnapshot::capture());
+    /* 暂存区按线程复用，每个进程不再单独分配 proc_info */
+    thread_local proc_info scratch;
     for (int pid : job.JobPIDs) {
         if (pid <= 0) continue;
-        auto info = snapshotOf(pid);
-        if (!info) continue;
-        // job.JobInfo[fmt::format("proc_info_{}", pid)] = info.get();
-        infos.emplace_back(std::move(info));
+        if (!snapshotOf(pid, *host, scratch)) continue;
+        appendRow(*batch, scratch);
     }
-    std::any a = std::move(infos); 
-    return a;
+    rates_.apply(*batch, std::chrono::steady_clock::now());
+    return batch;
 }
 
 namespace {
@@ -264,6 +317,30 @@ namespace {
 bool ProcCollector::init(const nlohmann::json& cfg) {
     spdlog::info("ProcCollector init with config: {}", cfg.dump());
     // 这里可以解析 cfg["interval"] 等
+    std::size_t max_pids = 4096;
+    try {
+        if (cfg.contains("fd_cache_max_pids"))
+            max_pids = std::stoul(cfg["fd_cache_max_pids"].get<std::string>());
+    } catch (const std::exception& e) {
+        spdlog::warn("ProcCollector: bad fd_cache_max_pids, using {}: {}", max_pids, e.what());
+    }
+    for (auto& s : shards_) {
+        std::lock_guard lg(s.m);
+        s.handle_cache.setCapacity((max_pids + kShards - 1) / kShards);
+    }
+
+    if (cfg.contains("per_thread"))
+        per_thread_ = cfg["per_thread"].get<std::string>() == "true";
+    spdlog::info("ProcCollector: per-thread sampling {}", per_thread_ ? "enabled" : "disabled");
+
+    /* 每个缓存的 PID 最多占用 7 个 fd（per_thread 模式下的 task 目录也算在内，
+       各线程的 stat 用完即关），尽量把软限制提到硬限制 */
+    rlimit rl{};
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &rl) != 0)
+            spdlog::warn("ProcCollector: raise RLIMIT_NOFILE failed: {}", strerror(errno));
+    }
     return true;
 }
 
@@ -271,8 +348,26 @@ CollectResult ProcCollector::collect(const Job& job) {
     return impl_collect(job);   // 复用你原来的 collect() 逻辑
 }
 
+bool ProcCollector::activity(const CollectResult& result, JobActivity& out) const {
+    using namespace proc_cols;
+    if (!result || &result->schema() != &procSchema()) return false;
+    out = JobActivity{};
+    for (double v : result->column(kCpuTimeSec)) out.cpuSeconds += v;
+    for (auto v : result->column(kIoReadCount))  out.ioBytes += v;
+    for (auto v : result->column(kIoWriteCount)) out.ioBytes += v;
+    return true;
+}
+
 void ProcCollector::deinit() noexcept {
     spdlog::info("ProcCollector deinit");
+    for (auto& s : shards_) {
+        std::lock_guard lg(s.m);
+        s.handle_cache.clear();
+        s.pid_state_dict.clear();
+        s.tid_state_dict.clear();
+    }
+    rates_.clear();
+    std::atomic_store(&host_, std::shared_ptr<const HostSnapshot>());
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "collector/proc_event_source.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <spdlog/spdlog.h>
+
+/* 事件编号属于内核 ABI；不同版本的 cn_proc.h 对枚举的作用域定义不同，这里直接使用数值 */
+namespace {
+constexpr __u32 kEventFork = 0x00000001;
+constexpr __u32 kEventExec = 0x00000002;
+constexpr __u32 kEventExit = 0x80000000;
+} // namespace
+
+ProcEventSource::ProcEventSource(Handlers h) : h_(std::move(h)) {}
+
+ProcEventSource::~ProcEventSource() { stop(); }
+
+bool ProcEventSource::subscribe(bool on) {
+    constexpr std::size_t kPayload = sizeof(cn_msg) + sizeof(proc_cn_mcast_op);
+    alignas(nlmsghdr) char buf[NLMSG_SPACE(kPayload)] = {};
+
+    auto* nh = reinterpret_cast<nlmsghdr*>(buf);
+    nh->nlmsg_len  = NLMSG_LENGTH(kPayload);
+    nh->nlmsg_type = NLMSG_DONE;
+    nh->nlmsg_pid  = 0;
+
+    auto* msg = static_cast<cn_msg*>(NLMSG_DATA(nh));
+    msg->id.idx = CN_IDX_PROC;
+    msg->id.val = CN_VAL_PROC;
+    msg->len    = sizeof(proc_cn_mcast_op);
+
+    proc_cn_mcast_op op = on ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+    std::memcpy(msg->data, &op, sizeof(op));
+
+    return ::send(sock_, buf, nh->nlmsg_len, 0) >= 0;
+}
+
+bool ProcEventSource::start() {
+    if (sock_ >= 0) return true;
+
+    sock_ = ::socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (sock_ < 0) {
+        spdlog::warn("ProcEventSource: socket failed: {}", strerror(errno));
+        return false;
+    }
+
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid    = 0;   // 由内核分配端口号
+    if (::bind(sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || !subscribe(true)) {
+        spdlog::warn("ProcEventSource: subscribe proc connector failed: {}", strerror(errno));
+        ::close(sock_);
+        sock_ = -1;
+        return false;
+    }
+
+    /* fork 风暴时事件量很大，尽量放大接收缓冲；超时用于检查停止标志 */
+    int rcvbuf = 8 * 1024 * 1024;
+    if (setsockopt(sock_, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) < 0)
+        setsockopt(sock_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv{0, 200 * 1000};
+    setsockopt(sock_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    stop_flag_ = false;
+    thread_ = std::thread([this] { loop(); });
+    spdlog::info("ProcEventSource: listening for process events");
+    return true;
+}
+
+void ProcEventSource::stop() {
+    stop_flag_ = true;
+    if (thread_.joinable()) thread_.join();
+    if (sock_ >= 0) {
+        subscribe(false);
+        ::close(sock_);
+        sock_ = -1;
+    }
+}
+
+void ProcEventSource::loop() {
+    alignas(nlmsghdr) char buf[16 * 1024];
+    int batched = 0;   // 上次 onDrained 之后处理的包数
+    sockaddr_nl from{};
+    auto receive = [&](int flags) {
+        socklen_t from_len = sizeof(from);
+        return ::recvfrom(sock_, buf, sizeof(buf), flags, reinterpret_cast<sockaddr*>(&from), &from_len);
+    };
+    while (!stop_flag_) {
+        ssize_t n = receive(MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            /* 队列已读空：先让调用方发布这一批，再阻塞等待 */
+            if (batched > 0 && h_.onDrained) h_.onDrained();
+            batched = 0;
+            n = receive(0);
+        }
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+            if (errno == ENOBUFS) {
+                spdlog::warn("ProcEventSource: receive buffer overflow, events lost");
+                if (h_.onLost) h_.onLost();
+                continue;
+            }
+            spdlog::error("ProcEventSource: recv failed: {}", strerror(errno));
+            break;
+        }
+        /* 只接受内核（nl_pid == 0）发来的 proc connector 消息，
+           本机其他进程伪造的 fork / exit 不能挂载或摘除作业的 PID */
+        if (from.nl_pid != 0) {
+            spdlog::debug("ProcEventSource: dropped datagram from netlink port {}", from.nl_pid);
+            continue;
+        }
+
+        int len = static_cast<int>(n);
+        for (auto* nh = reinterpret_cast<nlmsghdr*>(buf); NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_type == NLMSG_NOOP) continue;
+            if (nh->nlmsg_type == NLMSG_ERROR || nh->nlmsg_type == NLMSG_OVERRUN) break;
+
+            auto* msg = static_cast<cn_msg*>(NLMSG_DATA(nh));
+            if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC) continue;
+            auto* ev = reinterpret_cast<proc_event*>(msg->data);
+
+            switch (static_cast<__u32>(ev->what)) {
+                case kEventFork: {
+                    const auto& f = ev->event_data.fork;
+                    if (f.child_pid != f.child_tgid) break;    // 新线程
+                    if (h_.onFork) h_.onFork(f.parent_tgid, f.child_tgid);
+                    break;
+                }
+                case kEventExec: {
+                    const auto& e = ev->event_data.exec;
+                    if (e.process_pid == e.process_tgid && h_.onExec) h_.onExec(e.process_tgid);
+                    break;
+                }
+                case kEventExit: {
+                    const auto& e = ev->event_data.exit;
+                    if (e.process_pid != e.process_tgid) break;  // 线程退出
+                    if (h_.onExit) h_.onExit(e.process_tgid);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        if (++batched >= kMaxBatch) {
+            if (h_.onDrained) h_.onDrained();
+            batched = 0;
+        }
+    }
+}
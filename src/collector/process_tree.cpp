@@ -0,0 +1,168 @@
+#include "collector/process_tree.hpp"
+#include "collector/procfs_reader.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_set>
+#include <dirent.h>
+#include <spdlog/spdlog.h>
+
+ProcessTree& ProcessTree::instance() {
+    static ProcessTree tree;
+    return tree;
+}
+
+void ProcessTree::link(int pid, const Node& node) {
+    nodes_[pid] = node;
+    if (node.ppid > 0) children_[node.ppid].push_back(pid);
+}
+
+void ProcessTree::unlinkDead(int pid, const Node& node) {
+    auto it = children_.find(node.ppid);
+    if (it != children_.end()) {
+        auto& v = it->second;
+        v.erase(std::remove(v.begin(), v.end(), pid), v.end());
+        /* 父进程已退出且不再有子进程时，整条记录可以丢弃 */
+        if (v.empty() && !nodes_.count(node.ppid)) children_.erase(it);
+    }
+    auto own = children_.find(pid);
+    if (own != children_.end() && own->second.empty()) children_.erase(own);
+}
+
+void ProcessTree::refresh(std::chrono::steady_clock::duration min_interval) {
+    std::lock_guard scan(scan_mtx_);
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_scan_ < min_interval) return;
+    last_scan_ = now;
+
+    /* 1. 列出 /proc 下所有 PID（锁外完成，不阻塞读者） */
+    scan_pids_.clear();
+    DIR* d = opendir("/proc");
+    if (!d) {
+        spdlog::error("ProcessTree: opendir /proc failed");
+        return;
+    }
+    while (dirent* ent = readdir(d)) {
+        const char* name = ent->d_name;
+        if (name[0] < '0' || name[0] > '9') continue;
+        scan_pids_.push_back(std::atoi(name));
+    }
+    closedir(d);
+
+    std::unique_lock lk(mtx_);
+    ++gen_;
+
+    std::lock_guard reach(reach_mtx_);
+
+    /* 2. 已知进程只刷新代号；新进程留待读取 stat。
+          作业树上的进程还要核对 starttime：两次扫描之间退出并被复用的 PID
+          若沿用旧节点，会把无关进程连同其子树算进作业 */
+    new_pids_.clear();
+    char* buf = procfs::thread_buffer();
+    char path[32];
+    for (int pid : scan_pids_) {
+        auto it = nodes_.find(pid);
+        if (it == nodes_.end()) {
+            new_pids_.push_back(pid);
+            continue;
+        }
+        it->second.gen = gen_;
+        if (!reached_.count(pid)) continue;
+        std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+        ssize_t n = procfs::read_file(path, buf, procfs::kReadBufSize);
+        procfs::StatFields stat;
+        if (n <= 0 || !procfs::parse_stat(buf, static_cast<std::size_t>(n), stat)) continue;
+        if (stat.starttime == it->second.starttime) continue;
+        /* 旧进程视为退出，新进程按新节点重新登记 */
+        Node dead = it->second;
+        nodes_.erase(it);
+        unlinkDead(pid, dead);
+        reached_.erase(pid);
+        new_pids_.push_back(pid);
+    }
+
+    /* 3. 新 PID 若还挂着旧进程（同号、已退出）遗留的子进程列表，说明 PID 被复用，
+          这些孤儿不能算作新进程的后代 */
+    for (int pid : new_pids_) children_.erase(pid);
+
+    for (int pid : new_pids_) {
+        std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+        ssize_t n = procfs::read_file(path, buf, procfs::kReadBufSize);
+        procfs::StatFields stat;
+        if (n <= 0 || !procfs::parse_stat(buf, static_cast<std::size_t>(n), stat)) continue;
+        link(pid, Node{stat.ppid, stat.starttime, gen_});
+    }
+
+    /* 4. 本轮未出现的进程已退出 */
+    for (auto it = nodes_.begin(); it != nodes_.end();) {
+        if (it->second.gen != gen_) {
+            Node dead = it->second;
+            int pid = it->first;
+            it = nodes_.erase(it);
+            unlinkDead(pid, dead);
+            reached_.erase(pid);
+        } else {
+            ++it;
+        }
+    }
+
+    spdlog::trace("ProcessTree: scanned {} pids, {} new, {} tracked",
+                  scan_pids_.size(), new_pids_.size(), nodes_.size());
+}
+
+template <typename Visit>
+void ProcessTree::walk(const std::vector<int>& roots, Visit&& visit) const {
+    std::unordered_set<int> seen;
+    std::vector<int> stack;
+    for (int root : roots) {
+        /* 不展开 init / kthreadd，否则会把整机进程都算进作业 */
+        if (root <= 2 || !seen.insert(root).second) continue;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int pid = stack.back();
+            stack.pop_back();
+            auto it = children_.find(pid);
+            if (it == children_.end()) continue;
+            for (int child : it->second) {
+                if (!seen.insert(child).second) continue;
+                if (!visit(child)) return;
+                stack.push_back(child);
+            }
+        }
+    }
+}
+
+std::vector<int> ProcessTree::expand(const std::vector<int>& roots) const {
+    std::vector<int> out(roots);
+    std::shared_lock lk(mtx_);
+    walk(roots, [&](int pid) {
+        if (nodes_.count(pid) && std::find(roots.begin(), roots.end(), pid) == roots.end())
+            out.push_back(pid);
+        return true;
+    });
+    std::lock_guard reach(reach_mtx_);
+    reached_.insert(out.begin(), out.end());
+    return out;
+}
+
+bool ProcessTree::hasLiveDescendant(const std::vector<int>& roots) const {
+    bool found = false;
+    std::shared_lock lk(mtx_);
+    int live = 0;
+    walk(roots, [&](int pid) {
+        found = nodes_.count(pid) > 0;
+        if (found) live = pid;
+        return !found;
+    });
+    if (found) {
+        std::lock_guard reach(reach_mtx_);
+        reached_.insert(live);
+    }
+    return found;
+}
+
+std::size_t ProcessTree::size() const {
+    std::shared_lock lk(mtx_);
+    return nodes_.size();
+}
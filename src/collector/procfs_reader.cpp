@@ -0,0 +1,431 @@
+#include "collector/procfs_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace procfs {
+
+char* thread_buffer() {
+    thread_local char buf[kReadBufSize];
+    return buf;
+}
+
+ssize_t pread_all(int fd, char* buf, std::size_t cap) {
+    std::size_t total = 0;
+    while (total < cap) {
+        ssize_t n = ::pread(fd, buf + total, cap - total, static_cast<off_t>(total));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        total += static_cast<std::size_t>(n);
+    }
+    return static_cast<ssize_t>(total);
+}
+
+bool open_failed_for_good(int err) {
+    return err == ENOENT || err == EACCES;
+}
+
+ssize_t read_file(const char* path, char* buf, std::size_t cap) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = pread_all(fd, buf, cap);
+    ::close(fd);
+    return n;
+}
+
+const char* find_key(const char* begin, const char* end, const char* key, std::size_t key_len) {
+    const char* p = begin;
+    while (p < end) {
+        if (static_cast<std::size_t>(end - p) >= key_len && std::memcmp(p, key, key_len) == 0)
+            return p + key_len;
+        const void* nl = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+        if (!nl) break;
+        p = static_cast<const char*>(nl) + 1;
+    }
+    return nullptr;
+}
+
+bool parse_stat(const char* buf, std::size_t len, StatFields& out) {
+    const char* end = buf + len;
+    const char* p = buf;
+
+    std::int64_t pid = 0;
+    if (!scan_i64(p, end, pid)) return false;
+    out.pid = static_cast<int>(pid);
+
+    /* 进程名可能包含空格和 ')'，以最后一个 ')' 为界 */
+    const char* lp = static_cast<const char*>(std::memchr(p, '(', static_cast<std::size_t>(end - p)));
+    if (!lp) return false;
+    const char* rp = end;
+    while (rp > lp && *(rp - 1) != ')') --rp;
+    if (rp == lp) return false;
+    --rp;   // 指向 ')'
+
+    std::size_t n = static_cast<std::size_t>(rp - lp - 1);
+    if (n > sizeof(out.comm) - 1) n = sizeof(out.comm) - 1;
+    std::memcpy(out.comm, lp + 1, n);
+    out.comm[n] = '\0';
+    out.comm_len = n;
+
+    p = rp + 1;
+    skip_spaces(p, end);
+    if (p >= end) return false;
+    out.state = *p++;                                       // 3
+
+    std::int64_t iv = 0;
+    if (!scan_i64(p, end, iv)) return false;                // 4 ppid
+    out.ppid = static_cast<int>(iv);
+
+    if (!skip_fields(p, end, 9)) return false;              // 5..13
+    if (!scan_u64(p, end, out.utime)) return false;         // 14
+    if (!scan_u64(p, end, out.stime)) return false;         // 15
+    if (!skip_fields(p, end, 4)) return false;              // 16..19
+    if (!scan_i64(p, end, out.num_threads)) return false;   // 20
+    if (!skip_fields(p, end, 1)) return false;              // 21
+    if (!scan_u64(p, end, out.starttime)) return false;     // 22
+    if (!skip_fields(p, end, 1)) return false;              // 23
+    if (!scan_i64(p, end, out.rss_pages)) return false;     // 24
+
+    /* 39 processor 在老内核上可能不存在，失败不影响前面的字段 */
+    if (skip_fields(p, end, 14) && scan_i64(p, end, iv))    // 25..38, 39
+        out.processor = static_cast<int>(iv);
+    return true;
+}
+
+bool parse_statm(const char* buf, std::size_t len, StatmFields& out) {
+    const char* p = buf;
+    const char* end = buf + len;
+    return scan_u64(p, end, out.size_pages) && scan_u64(p, end, out.resident_pages);
+}
+
+bool parse_status(const char* buf, std::size_t len, StatusFields& out) {
+    const char* end = buf + len;
+    const char* p = find_key(buf, end, "VmRSS:", 6);
+    if (p) scan_u64(p, end, out.vm_rss_kb);                 // 内核线程没有 VmRSS
+
+    p = find_key(buf, end, "Threads:", 8);
+    if (!p) return false;
+    return scan_i64(p, end, out.threads);
+}
+
+bool parse_io(const char* buf, std::size_t len, IoFields& out) {
+    const char* end = buf + len;
+    const char* r = find_key(buf, end, "read_bytes:", 11);
+    const char* w = find_key(buf, end, "write_bytes:", 12);
+    if (!r || !w) return false;
+    return scan_u64(r, end, out.read_bytes) && scan_u64(w, end, out.write_bytes);
+}
+
+bool parse_smaps_rollup(const char* buf, std::size_t len, SmapsRollupFields& out) {
+    const char* end = buf + len;
+    auto field = [&](const char* key, std::size_t key_len, std::uint64_t& v) {
+        const char* p = find_key(buf, end, key, key_len);
+        return p && scan_u64(p, end, v);
+    };
+    if (!field("Rss:", 4, out.rss_kb) || !field("Pss:", 4, out.pss_kb)) return false;
+    field("Pss_Anon:", 9, out.pss_anon_kb);
+    field("Pss_File:", 9, out.pss_file_kb);
+    field("Pss_Shmem:", 10, out.pss_shmem_kb);
+    field("Private_Clean:", 14, out.private_clean_kb);
+    field("Private_Dirty:", 14, out.private_dirty_kb);
+    field("Anonymous:", 10, out.anonymous_kb);
+    field("Swap:", 5, out.swap_kb);
+    field("SwapPss:", 8, out.swap_pss_kb);
+    return true;
+}
+
+bool parse_meminfo_total(const char* buf, std::size_t len, std::uint64_t& kb) {
+    const char* end = buf + len;
+    const char* p = find_key(buf, end, "MemTotal:", 9);
+    return p && scan_u64(p, end, kb);
+}
+
+bool parse_cpu_total(const char* buf, std::size_t len, std::uint64_t& jiffies) {
+    const char* end = buf + len;
+    const char* p = find_key(buf, end, "cpu ", 4);
+    if (!p) return false;
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    if (eol) end = eol;
+
+    std::uint64_t v = 0, sum = 0;
+    while (scan_u64(p, end, v)) sum += v;
+    jiffies = sum;
+    return true;
+}
+
+bool parse_boot_time(const char* buf, std::size_t len, std::uint64_t& secs) {
+    const char* end = buf + len;
+    const char* p = find_key(buf, end, "btime ", 6);
+    return p && scan_u64(p, end, secs);
+}
+
+/* ---------- fd 统计 ---------- */
+
+namespace {
+
+enum FdKind : std::uint8_t { kSocket, kPipe, kFile, kAnonInode, kOther };
+
+struct linux_dirent64 {
+    std::uint64_t  d_ino;
+    std::int64_t   d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[];
+};
+
+FdKind classify_fd(int fd_dir, const char* name) {
+    char target[64];   // 只需要前缀，截断无妨
+    ssize_t n = ::readlinkat(fd_dir, name, target, sizeof(target));
+    if (n <= 0) return kOther;
+    auto starts = [&](const char* prefix, std::size_t len) {
+        return static_cast<std::size_t>(n) >= len && std::memcmp(target, prefix, len) == 0;
+    };
+    if (target[0] == '/')            return kFile;
+    if (starts("socket:[", 8))       return kSocket;
+    if (starts("pipe:[", 6))         return kPipe;
+    if (starts("anon_inode:", 11))   return kAnonInode;
+    return kOther;
+}
+
+} // namespace
+
+bool list_numeric_dir(int dir_fd, std::vector<int>& out) {
+    out.clear();
+    if (::lseek(dir_fd, 0, SEEK_SET) < 0) return false;
+    char* buf = thread_buffer();
+    for (;;) {
+        long n = ::syscall(SYS_getdents64, dir_fd, buf, kReadBufSize);
+        if (n < 0) return false;
+        if (n == 0) break;
+        for (long off = 0; off < n;) {
+            auto* d = reinterpret_cast<linux_dirent64*>(buf + off);
+            off += d->d_reclen;
+            const char* p = d->d_name;
+            std::uint64_t v = 0;
+            if (scan_u64(p, p + std::strlen(p), v)) out.push_back(static_cast<int>(v));
+        }
+    }
+    if (!std::is_sorted(out.begin(), out.end())) std::sort(out.begin(), out.end());
+    return true;
+}
+
+bool census_fds(int fd_dir, FdCensusState* state, FdCensus& out) {
+    thread_local std::vector<int> cur;
+    thread_local std::vector<std::uint8_t> kinds;
+    if (!list_numeric_dir(fd_dir, cur)) return false;   // 进程已退出
+
+    if (state && cur == state->fds) {
+        out = state->last;
+        return true;
+    }
+
+    /* 与上次的列表归并：已知编号复用分类，只为新编号 readlinkat */
+    kinds.resize(cur.size());
+    std::size_t j = 0;
+    char name[16];
+    for (std::size_t i = 0; i < cur.size(); ++i) {
+        if (state) {
+            while (j < state->fds.size() && state->fds[j] < cur[i]) ++j;
+            if (j < state->fds.size() && state->fds[j] == cur[i]) {
+                kinds[i] = state->kinds[j];
+                continue;
+            }
+        }
+        std::snprintf(name, sizeof(name), "%d", cur[i]);
+        kinds[i] = classify_fd(fd_dir, name);
+    }
+
+    out = FdCensus{};
+    out.total = static_cast<std::uint32_t>(cur.size());
+    for (auto k : kinds) {
+        switch (k) {
+            case kSocket:    ++out.sockets;    break;
+            case kPipe:      ++out.pipes;      break;
+            case kFile:      ++out.files;      break;
+            case kAnonInode: ++out.anonInodes; break;
+            default:         ++out.other;      break;
+        }
+    }
+
+    if (state) {
+        /* 交换而不是拷贝，两边的容量都得以复用 */
+        state->fds.swap(cur);
+        state->kinds.swap(kinds);
+        state->last = out;
+    }
+    return true;
+}
+
+/* ---------- PidHandle ---------- */
+
+static const char* const kPidFileNames[] = {"stat", "statm", "status", "io", "smaps_rollup"};
+
+PidHandle& PidHandle::operator=(PidHandle&& o) noexcept {
+    if (this != &o) {
+        close();
+        pid_ = std::exchange(o.pid_, -1);
+        dir_fd_ = std::exchange(o.dir_fd_, -1);
+        for (int i = 0; i < static_cast<int>(PidFile::Count); ++i)
+            fds_[i] = std::exchange(o.fds_[i], -1);
+        fd_dir_fd_ = std::exchange(o.fd_dir_fd_, -1);
+        fd_state_ = std::move(o.fd_state_);
+        task_dir_fd_ = std::exchange(o.task_dir_fd_, -1);
+        tids_ = std::move(o.tids_);
+        o.tids_.clear();
+        starttime = o.starttime;
+        last_used = o.last_used;
+    }
+    return *this;
+}
+
+bool PidHandle::open(int pid) {
+    close();
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/%d", pid);
+    dir_fd_ = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd_ < 0) return false;
+    pid_ = pid;
+    return true;
+}
+
+void PidHandle::close() noexcept {
+    for (int& fd : fds_) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    if (fd_dir_fd_ >= 0) ::close(fd_dir_fd_);
+    fd_dir_fd_ = -1;
+    fd_state_ = FdCensusState{};
+    closeThreads();
+    if (dir_fd_ >= 0) ::close(dir_fd_);
+    dir_fd_ = -1;
+    pid_ = -1;
+    starttime = 0;
+}
+
+ssize_t PidHandle::read(PidFile f, char* buf, std::size_t cap) {
+    if (dir_fd_ < 0) return -1;
+    int& fd = fds_[static_cast<int>(f)];
+    if (fd == kUnavailable) return -1;
+    if (fd < 0) {
+        fd = ::openat(dir_fd_, kPidFileNames[static_cast<int>(f)], O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (open_failed_for_good(errno)) fd = kUnavailable;
+            return -1;
+        }
+    }
+    return pread_all(fd, buf, cap);
+}
+
+bool PidHandle::fdCensus(FdCensus& out) {
+    if (dir_fd_ < 0) return false;
+    if (fd_dir_fd_ == kUnavailable) return false;
+    if (fd_dir_fd_ < 0) {
+        fd_dir_fd_ = ::openat(dir_fd_, "fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd_dir_fd_ < 0) {
+            if (open_failed_for_good(errno)) fd_dir_fd_ = kUnavailable;
+            return false;
+        }
+    }
+    return census_fds(fd_dir_fd_, &fd_state_, out);
+}
+
+void PidHandle::closeThreads() noexcept {
+    tids_.clear();
+    if (task_dir_fd_ >= 0) ::close(task_dir_fd_);
+    task_dir_fd_ = -1;
+}
+
+bool PidHandle::relistThreads() {
+    return list_numeric_dir(task_dir_fd_, tids_);
+}
+
+/* 线程的 stat 每次 openat + pread + close：宽进程的线程数可达上千，
+   跨周期保持打开会让 fd 数随线程数增长，挤占写入器 socket、pidfd 等的额度 */
+ssize_t PidHandle::readThreadStat(std::size_t i, char* buf, std::size_t cap) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%d/stat", tids_[i]);
+    int fd = ::openat(task_dir_fd_, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;   // 线程已退出，或 fd 耗尽（下次再试）
+    ssize_t n = pread_all(fd, buf, cap);
+    ::close(fd);
+    return n;
+}
+
+bool PidHandle::readThreads(std::int64_t num_threads, std::vector<ThreadStat>& out) {
+    out.clear();
+    if (dir_fd_ < 0 || task_dir_fd_ == kUnavailable) return false;
+    if (task_dir_fd_ < 0) {
+        task_dir_fd_ = ::openat(dir_fd_, "task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (task_dir_fd_ < 0) {
+            if (open_failed_for_good(errno)) task_dir_fd_ = kUnavailable;
+            return false;
+        }
+    }
+
+    bool relisted = false;
+    if (static_cast<std::int64_t>(tids_.size()) != num_threads) {
+        if (!relistThreads()) return false;
+        relisted = true;
+    }
+
+    char* buf = thread_buffer();
+    for (;;) {
+        bool stale = false;
+        for (std::size_t i = 0; i < tids_.size(); ++i) {
+            ThreadStat ts;
+            ts.tid = tids_[i];
+            ssize_t n = readThreadStat(i, buf, kReadBufSize);
+            if (n <= 0 || !parse_stat(buf, static_cast<std::size_t>(n), ts.stat)) {
+                stale = true;
+                continue;
+            }
+            out.push_back(ts);
+        }
+        /* 线程数不变但有线程被替换时，读到已退出的线程会失败，重新列一次目录 */
+        if (!stale || relisted) return true;
+        out.clear();
+        if (!relistThreads()) return false;
+        relisted = true;
+    }
+}
+
+/* ---------- PidHandleCache ---------- */
+
+PidHandle* PidHandleCache::acquire(int pid) {
+    auto now = std::chrono::steady_clock::now();
+    auto it = handles_.find(pid);
+    if (it != handles_.end()) {
+        it->second.last_used = now;
+        return &it->second;
+    }
+    if (handles_.size() >= capacity_) return nullptr;
+
+    PidHandle h;
+    if (!h.open(pid)) return nullptr;
+    h.last_used = now;
+    return &handles_.emplace(pid, std::move(h)).first->second;
+}
+
+void PidHandleCache::invalidate(int pid) {
+    handles_.erase(pid);
+}
+
+void PidHandleCache::sweep(std::chrono::steady_clock::duration idle) {
+    auto deadline = std::chrono::steady_clock::now() - idle;
+    for (auto it = handles_.begin(); it != handles_.end();) {
+        if (it->second.last_used < deadline) it = handles_.erase(it);
+        else ++it;
+    }
+}
+
+} // namespace procfs
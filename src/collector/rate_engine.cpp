@@ -0,0 +1,71 @@
+#include "collector/rate_engine.hpp"
+
+std::optional<double> RateEngine::rate(const Key& key, std::uint64_t value, Clock::time_point now) {
+    auto& s = shardOf(key.id);
+    std::lock_guard lg(s.m);
+    auto [it, inserted] = s.baselines.try_emplace(key);
+    baseline& b = it->second;
+    if (inserted) {
+        b.value = value;
+        b.ts    = now;
+        return std::nullopt;
+    }
+    if (now - b.ts < kMinInterval) {
+        if (!b.hasRate) return std::nullopt;
+        return b.rate;
+    }
+    /* 计数器变小：源头已归零重启，本段增量就是当前值 */
+    std::uint64_t delta = value >= b.value ? value - b.value : value;
+    double secs = std::chrono::duration<double>(now - b.ts).count();
+    b.rate    = static_cast<double>(delta) / secs;
+    b.hasRate = true;
+    b.value   = value;
+    b.ts      = now;
+    return b.rate;
+}
+
+void RateEngine::applyOne(SampleBatch& batch, Clock::time_point now) {
+    const RateSpec* spec = batch.schema().rates();
+    if (!spec) return;
+    const auto& ids = std::get<std::pmr::vector<std::int64_t>>(batch.data(spec->idColumn));
+    const std::pmr::vector<std::uint64_t>* gens = nullptr;
+    if (spec->generationColumn != RateSpec::kNoColumn)
+        gens = &std::get<std::pmr::vector<std::uint64_t>>(batch.data(spec->generationColumn));
+
+    for (const auto& c : spec->counters) {
+        const auto& values = std::get<std::pmr::vector<std::uint64_t>>(batch.data(c.counter));
+        auto& rates = std::get<std::pmr::vector<double>>(batch.data(c.rate));
+        for (std::size_t r = 0; r < batch.rows(); ++r) {
+            Key key{ids[r], gens ? (*gens)[r] : 0, static_cast<std::uint32_t>(c.counter)};
+            if (auto v = rate(key, values[r], now)) rates[r] = *v;
+        }
+    }
+}
+
+void RateEngine::apply(SampleBatch& batch, Clock::time_point now) {
+    applyOne(batch, now);
+    if (batch.child()) applyOne(*batch.child(), now);
+}
+
+void RateEngine::sweep(Clock::duration idle) {
+    auto now = Clock::now();
+    {
+        std::lock_guard lg(sweep_m_);
+        if (now - last_sweep_ < idle) return;
+        last_sweep_ = now;
+    }
+    for (auto& s : shards_) {
+        std::lock_guard lg(s.m);
+        for (auto it = s.baselines.begin(); it != s.baselines.end();) {
+            if (now - it->second.ts > idle) it = s.baselines.erase(it);
+            else ++it;
+        }
+    }
+}
+
+void RateEngine::clear() {
+    for (auto& s : shards_) {
+        std::lock_guard lg(s.m);
+        s.baselines.clear();
+    }
+}
@@ -0,0 +1,96 @@
+#include "collector/sample_batch.hpp"
+#include "collector/tick_arena.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+Schema::Schema(std::string name, std::int8_t collectorType, std::vector<ColumnDesc> columns,
+               const Schema* child, const char* childName)
+    : name_(std::move(name)), collectorType_(collectorType), columns_(std::move(columns)),
+      child_(child), childName_(childName) {
+    for (std::size_t i = 0; i < columns_.size(); ++i)
+        if (columns_[i].index != i)
+            throw std::invalid_argument("Schema " + name_ + ": column " + columns_[i].name + " is out of order");
+    if (child_ && !childName_)
+        throw std::invalid_argument("Schema " + name_ + ": child schema without a name");
+}
+
+Schema&& Schema::withRates(RateSpec spec) && {
+    auto expect = [this](std::size_t index, ColumnType type, const char* what) {
+        if (index >= columns_.size() || columns_[index].type != type)
+            throw std::invalid_argument("Schema " + name_ + ": bad " + what + " column for rates");
+    };
+    expect(spec.idColumn, ColumnType::Int64, "id");
+    if (spec.generationColumn != RateSpec::kNoColumn) expect(spec.generationColumn, ColumnType::UInt64, "generation");
+    for (const auto& c : spec.counters) {
+        expect(c.counter, ColumnType::UInt64, "counter");
+        expect(c.rate, ColumnType::Double, "rate");
+    }
+    rates_ = std::move(spec);
+    return std::move(*this);
+}
+
+namespace {
+
+SampleBatch::ColumnData makeColumn(ColumnType type, std::pmr::memory_resource* mr) {
+    switch (type) {
+        case ColumnType::Int64:  return std::pmr::vector<std::int64_t>(mr);
+        case ColumnType::UInt64: return std::pmr::vector<std::uint64_t>(mr);
+        case ColumnType::Double: return std::pmr::vector<double>(mr);
+        case ColumnType::String: return std::pmr::vector<std::string_view>(mr);
+        case ColumnType::Bool:   return std::pmr::vector<std::uint8_t>(mr);
+    }
+    throw std::invalid_argument("SampleBatch: unknown column type");
+}
+
+} // namespace
+
+SampleBatch::SampleBatch(const Schema& schema) : SampleBatch(schema, TickArena::current()) {}
+
+SampleBatch::SampleBatch(const Schema& schema, std::shared_ptr<TickArena> arena)
+    : arena_(std::move(arena)),
+      own_(arena_ ? nullptr : std::make_unique<std::pmr::monotonic_buffer_resource>()),
+      mr_(arena_ ? arena_->resource() : own_.get()),
+      schema_(&schema),
+      childBegin_(mr_) {
+    cols_.reserve(schema.columns().size());
+    for (const auto& c : schema.columns()) cols_.push_back(makeColumn(c.type, mr_));
+    if (schema.child()) child_.reset(new SampleBatch(*schema.child(), arena_));
+}
+
+/* 列先于 arena_ 析构（成员逆序析构），arena 的最后一个引用释放时才复位 */
+SampleBatch::~SampleBatch() = default;
+
+void SampleBatch::setString(std::size_t row, const Col<std::string_view>& c, std::string_view v) {
+    if (v.empty()) {
+        column(c)[row] = {};
+        return;
+    }
+    auto* p = static_cast<char*>(mr_->allocate(v.size(), 1));
+    std::memcpy(p, v.data(), v.size());
+    column(c)[row] = std::string_view(p, v.size());
+}
+
+void SampleBatch::setInterned(std::size_t row, const Col<std::string_view>& c, std::string_view v) {
+    if (auto sv = NameInterner::instance().intern(v)) column(c)[row] = *sv;
+    else setString(row, c, v);
+}
+
+void SampleBatch::reserve(std::size_t rows) {
+    for (auto& col : cols_)
+        std::visit([rows](auto& v) { v.reserve(rows); }, col);
+    if (child_) childBegin_.reserve(rows);
+}
+
+std::size_t SampleBatch::appendRow() {
+    for (auto& col : cols_)
+        std::visit([](auto& v) { v.emplace_back(); }, col);
+    if (child_) childBegin_.push_back(child_->rows());
+    return rows_++;
+}
+
+std::pair<std::size_t, std::size_t> SampleBatch::childRange(std::size_t row) const {
+    if (!child_ || row >= rows_) return {0, 0};
+    std::size_t end = row + 1 < rows_ ? childBegin_[row + 1] : child_->rows();
+    return {childBegin_[row], end};
+}
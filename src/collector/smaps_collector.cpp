@@ -0,0 +1,183 @@
+#include "collector/smaps_collector.hpp"
+#include "collector/collector_registry.hpp"
+
+#include <cstdio>
+#include <spdlog/spdlog.h>
+
+namespace smaps_collector {
+
+namespace {
+
+ssize_t readPidFile(int pid, const char* name) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+    return procfs::read_file(path, procfs::thread_buffer(), procfs::kReadBufSize);
+}
+
+void accumulate(smaps_info& total, const smaps_info& s) {
+    total.rssKb      += s.rssKb;
+    total.pssKb      += s.pssKb;
+    total.pssAnonKb  += s.pssAnonKb;
+    total.pssFileKb  += s.pssFileKb;
+    total.pssShmemKb += s.pssShmemKb;
+    total.ussKb      += s.ussKb;
+    total.swapKb     += s.swapKb;
+    total.swapPssKb  += s.swapPssKb;
+}
+
+} // namespace
+
+const Schema& smapsSchema() {
+    using namespace cols;
+    static const Schema schema("smaps", int8_t(CollectorType::SmapsCollector), {
+        Schema::column(kScope), Schema::column(kPid), Schema::column(kName), Schema::column(kRssKb),
+        Schema::column(kPssKb), Schema::column(kPssAnonKb), Schema::column(kPssFileKb),
+        Schema::column(kPssShmemKb), Schema::column(kUssKb), Schema::column(kSwapKb),
+        Schema::column(kSwapPssKb), Schema::column(kReused),
+    });
+    return schema;
+}
+
+void SmapsCollector::appendRow(SampleBatch& batch, const smaps_info& info, const char* scope) {
+    using namespace cols;
+    std::size_t r = batch.appendRow();
+    batch.setInterned(r, kScope, scope);
+    batch.set(r, kPid, info.pid);
+    batch.setInterned(r, kName, info.name);
+    batch.set(r, kRssKb, info.rssKb);
+    batch.set(r, kPssKb, info.pssKb);
+    batch.set(r, kPssAnonKb, info.pssAnonKb);
+    batch.set(r, kPssFileKb, info.pssFileKb);
+    batch.set(r, kPssShmemKb, info.pssShmemKb);
+    batch.set(r, kUssKb, info.ussKb);
+    batch.set(r, kSwapKb, info.swapKb);
+    batch.set(r, kSwapPssKb, info.swapPssKb);
+    batch.set(r, kReused, info.reused);
+}
+
+/* 结果拷贝到 out；只锁 pid 所在的分片 */
+bool SmapsCollector::sample(int pid, smaps_info& out) {
+    auto& s = shardOf(pid);
+    std::lock_guard lg(s.m);
+    char* buf = procfs::thread_buffer();
+    procfs::PidHandle* h = s.handle_cache.acquire(pid);
+    auto readFile = [&](procfs::PidFile f, const char* name) -> ssize_t {
+        return h ? h->read(f, buf, procfs::kReadBufSize) : readPidFile(pid, name);
+    };
+
+    /* 1. stat：starttime 识别 PID 复用，rss 判断是否需要重读 smaps_rollup */
+    procfs::StatFields stat;
+    ssize_t n = readFile(procfs::PidFile::Stat, "stat");
+    if (n <= 0 || !procfs::parse_stat(buf, static_cast<std::size_t>(n), stat)) {
+        s.handle_cache.invalidate(pid);
+        s.cache.erase(pid);
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto& c = s.cache[pid];
+    if (c.starttime != stat.starttime) {   // 新进程（或 PID 复用），丢弃旧结果
+        c = pid_cache{};
+        c.starttime = stat.starttime;
+    }
+    c.lastSeen = now;
+
+    /* 2. RSS 未变化且结果未过期时沿用上次的数据。
+          他人退出会改变共享页的均摊，所以 PSS 仍需按 max_age 定期刷新 */
+    if (c.rssPages == stat.rss_pages && now - c.lastRead < max_age_) {
+        c.info.reused = true;
+        out = c.info;
+        return true;
+    }
+
+    /* 3. smaps_rollup ------------------------------------------------------- */
+    n = readFile(procfs::PidFile::SmapsRollup, "smaps_rollup");
+    procfs::SmapsRollupFields r;
+    if (n <= 0 || !procfs::parse_smaps_rollup(buf, static_cast<std::size_t>(n), r)) {
+        spdlog::trace("SmapsCollector: read smaps_rollup of pid {} failed", pid);
+        return false;
+    }
+
+    smaps_info& info = c.info;
+    info = smaps_info{};
+    info.pid        = pid;
+    info.name.assign(stat.comm, stat.comm_len);
+    info.rssKb      = r.rss_kb;
+    info.pssKb      = r.pss_kb;
+    info.pssAnonKb  = r.pss_anon_kb;
+    info.pssFileKb  = r.pss_file_kb;
+    info.pssShmemKb = r.pss_shmem_kb;
+    info.ussKb      = r.private_clean_kb + r.private_dirty_kb;
+    info.swapKb     = r.swap_kb;
+    info.swapPssKb  = r.swap_pss_kb;
+    c.rssPages = stat.rss_pages;
+    c.lastRead = now;
+    out = info;
+    return true;
+}
+
+void SmapsCollector::sweepIdle() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_sweep_ < kIdleTimeout) return;
+    last_sweep_ = now;
+
+    for (auto& s : shards_) {
+        std::lock_guard lg(s.m);
+        s.handle_cache.sweep(kIdleTimeout);
+        for (auto it = s.cache.begin(); it != s.cache.end();) {
+            if (now - it->second.lastSeen > kIdleTimeout) it = s.cache.erase(it);
+            else ++it;
+        }
+    }
+}
+
+void SmapsCollector::beginTick(const TickContext&) {
+    sweepIdle();
+}
+
+bool SmapsCollector::init(const nlohmann::json& cfg) {
+    spdlog::info("SmapsCollector init with config: {}", cfg.dump());
+    try {
+        if (cfg.contains("max_age"))
+            max_age_ = std::chrono::seconds(std::stoul(cfg["max_age"].get<std::string>()));
+    } catch (const std::exception& e) {
+        spdlog::warn("SmapsCollector: bad max_age, using {}s: {}",
+                     std::chrono::duration_cast<std::chrono::seconds>(max_age_).count(), e.what());
+    }
+    return true;
+}
+
+CollectResult SmapsCollector::collect(const Job& job) {
+    auto batch = std::make_shared<SampleBatch>(smapsSchema());
+    batch->reserve(job.JobPIDs.size() + 1);
+    smaps_info total;
+    total.name = "job";
+    smaps_info info;
+    for (int pid : job.JobPIDs) {
+        if (pid <= 0 || !sample(pid, info)) continue;
+        accumulate(total, info);
+        appendRow(*batch, info, "process");
+    }
+    appendRow(*batch, total, "job");
+    return batch;
+}
+
+void SmapsCollector::deinit() noexcept {
+    spdlog::info("SmapsCollector deinit");
+    for (auto& s : shards_) {
+        std::lock_guard lg(s.m);
+        s.handle_cache.clear();
+        s.cache.clear();
+    }
+}
+
+namespace {
+    struct AutoReg {
+        AutoReg() {
+            CollectorRegistry::instance().registerCollector<SmapsCollector>(COLLECTOR_TYPE_SMAPS);
+        }
+    };
+    static AutoReg _auto_reg;
+}
+
+} // namespace smaps_collector
@@ -0,0 +1,377 @@
+#include "collector/taskstats_collector.hpp"
+#include "collector/collector_registry.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <linux/genetlink.h>
+#include <linux/netlink.h>
+#include <linux/taskstats.h>
+#include <spdlog/spdlog.h>
+
+namespace taskstats_collector {
+
+namespace {
+
+constexpr std::size_t kMsgBufSize = 8 * 1024;
+
+/* genetlink 请求：nlmsghdr + genlmsghdr + 若干属性 */
+struct alignas(NLMSG_ALIGNTO) Request {
+    nlmsghdr   n;
+    genlmsghdr g;
+    char       attrs[64];
+};
+
+void putAttr(Request& req, std::uint16_t type, const void* data, std::size_t len) {
+    auto* na = reinterpret_cast<nlattr*>(reinterpret_cast<char*>(&req) + NLMSG_ALIGN(req.n.nlmsg_len));
+    na->nla_type = type;
+    na->nla_len  = static_cast<std::uint16_t>(NLA_HDRLEN + len);
+    std::memcpy(reinterpret_cast<char*>(na) + NLA_HDRLEN, data, len);
+    req.n.nlmsg_len = NLMSG_ALIGN(req.n.nlmsg_len) + NLA_ALIGN(na->nla_len);
+}
+
+/* 遍历 [p, p+len) 中的属性 */
+template <typename F>
+void forEachAttr(const char* p, int len, F&& f) {
+    while (len >= static_cast<int>(NLA_HDRLEN)) {
+        auto* na = reinterpret_cast<const nlattr*>(p);
+        if (na->nla_len < NLA_HDRLEN || na->nla_len > len) break;
+        f(na, p + NLA_HDRLEN, static_cast<int>(na->nla_len - NLA_HDRLEN));
+        int step = NLA_ALIGN(na->nla_len);
+        p += step;
+        len -= step;
+    }
+}
+
+} // namespace
+
+bool TaskstatsCollector::openSocket() {
+    sock_ = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (sock_ < 0) {
+        spdlog::error("TaskstatsCollector: socket failed: {}", strerror(errno));
+        return false;
+    }
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    if (::bind(sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        spdlog::error("TaskstatsCollector: bind failed: {}", strerror(errno));
+        ::close(sock_);
+        sock_ = -1;
+        return false;
+    }
+    timeval tv{1, 0};   // 内核正常情况下立即应答，超时只用于兜底
+    setsockopt(sock_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return true;
+}
+
+bool TaskstatsCollector::resolveFamily() {
+    Request req{};
+    req.n.nlmsg_len   = NLMSG_LENGTH(GENL_HDRLEN);
+    req.n.nlmsg_type  = GENL_ID_CTRL;
+    req.n.nlmsg_flags = NLM_F_REQUEST;
+    req.n.nlmsg_seq   = ++seq_;
+    req.g.cmd         = CTRL_CMD_GETFAMILY;
+    req.g.version     = 1;
+    putAttr(req, CTRL_ATTR_FAMILY_NAME, TASKSTATS_GENL_NAME, sizeof(TASKSTATS_GENL_NAME));
+
+    if (::send(sock_, &req, req.n.nlmsg_len, 0) < 0) return false;
+
+    alignas(nlmsghdr) char buf[kMsgBufSize];
+    ssize_t n = ::recv(sock_, buf, sizeof(buf), 0);
+    if (n < 0) return false;
+
+    auto* nh = reinterpret_cast<nlmsghdr*>(buf);
+    if (!NLMSG_OK(nh, n) || nh->nlmsg_type == NLMSG_ERROR) return false;
+
+    const char* attrs = static_cast<const char*>(NLMSG_DATA(nh)) + GENL_HDRLEN;
+    int len = static_cast<int>(nh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+    forEachAttr(attrs, len, [&](const nlattr* na, const char* data, int) {
+        if (na->nla_type == CTRL_ATTR_FAMILY_ID) std::memcpy(&family_, data, sizeof(family_));
+    });
+    return family_ != 0;
+}
+
+bool TaskstatsCollector::sendQuery(int pid, std::uint32_t seq) {
+    Request req{};
+    req.n.nlmsg_len   = NLMSG_LENGTH(GENL_HDRLEN);
+    req.n.nlmsg_type  = family_;
+    req.n.nlmsg_flags = NLM_F_REQUEST;
+    req.n.nlmsg_seq   = seq;
+    req.g.cmd         = TASKSTATS_CMD_GET;
+    req.g.version     = TASKSTATS_GENL_VERSION;
+    std::uint32_t id  = static_cast<std::uint32_t>(pid);
+    putAttr(req, per_tgid_ ? TASKSTATS_CMD_ATTR_TGID : TASKSTATS_CMD_ATTR_PID, &id, sizeof(id));
+    return ::send(sock_, &req, req.n.nlmsg_len, 0) >= 0;
+}
+
+bool TaskstatsCollector::query(int pid, taskstats_info& out) {
+    std::uint32_t seq = ++seq_;
+    if (!sendQuery(pid, seq)) return false;
+
+    /* 之前超时的请求的迟到应答序号更小，直接丢弃 */
+    alignas(nlmsghdr) char buf[kMsgBufSize];
+    nlmsghdr* nh = nullptr;
+    do {
+        ssize_t n = ::recv(sock_, buf, sizeof(buf), 0);
+        if (n < 0) return false;
+        nh = reinterpret_cast<nlmsghdr*>(buf);
+        if (!NLMSG_OK(nh, n)) return false;
+    } while (nh->nlmsg_seq != seq);
+    return parseReply(nh, pid, out);
+}
+
+void TaskstatsCollector::queryMany(const std::vector<int>& pids, std::vector<taskstats_info>& out,
+                                   std::vector<char>& ok) {
+    out.resize(pids.size());
+    ok.assign(pids.size(), 0);
+    /* 先整段预留序号：下个周期的序号与本周期不重叠，超时后的迟到应答落不进新的范围 */
+    const std::uint32_t base = seq_ + 1;
+    seq_ += static_cast<std::uint32_t>(pids.size());
+    std::vector<char> replied(pids.size(), 0);
+    std::size_t sent = 0, done = 0;
+    alignas(nlmsghdr) char buf[kMsgBufSize];
+    while (done < pids.size()) {
+        /* 保持至多 kWindow 个请求在途，避免应答挤爆 socket 接收缓冲区 */
+        while (sent < pids.size() && sent - done < kWindow) {
+            if (!sendQuery(pids[sent], base + static_cast<std::uint32_t>(sent))) return;
+            ++sent;
+        }
+        ssize_t n = ::recv(sock_, buf, sizeof(buf), 0);
+        if (n < 0) return;   // 超时：剩余的 PID 本周期放弃
+        auto* nh = reinterpret_cast<nlmsghdr*>(buf);
+        if (!NLMSG_OK(nh, n)) return;
+        std::size_t i = nh->nlmsg_seq - base;   // 之前超时请求的迟到应答落在范围外
+        if (i >= sent || replied[i]) continue;
+        replied[i] = 1;
+        ++done;
+        ok[i] = parseReply(nh, pids[i], out[i]);
+    }
+}
+
+bool TaskstatsCollector::parseReply(const nlmsghdr* nh, int pid, taskstats_info& out) {
+    if (nh->nlmsg_type == NLMSG_ERROR) return false;   // 进程已退出（ESRCH）或无权限
+
+    taskstats ts{};
+    bool found = false;
+    bool other = false;   // 应答里的 PID / TGID 与请求的不符
+    const char* attrs = static_cast<const char*>(NLMSG_DATA(nh)) + GENL_HDRLEN;
+    int len = static_cast<int>(nh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+    forEachAttr(attrs, len, [&](const nlattr* na, const char* data, int dlen) {
+        if (na->nla_type != TASKSTATS_TYPE_AGGR_TGID && na->nla_type != TASKSTATS_TYPE_AGGR_PID) return;
+        forEachAttr(data, dlen, [&](const nlattr* inner, const char* idata, int ilen) {
+            if (inner->nla_type == TASKSTATS_TYPE_PID || inner->nla_type == TASKSTATS_TYPE_TGID) {
+                std::uint32_t id = 0;
+                std::memcpy(&id, idata, std::min<std::size_t>(sizeof(id), static_cast<std::size_t>(ilen)));
+                if (id != static_cast<std::uint32_t>(pid)) other = true;
+                return;
+            }
+            if (inner->nla_type != TASKSTATS_TYPE_STATS) return;
+            /* 老内核的结构体可能更短，按实际长度拷贝 */
+            std::memcpy(&ts, idata, std::min<std::size_t>(sizeof(ts), static_cast<std::size_t>(ilen)));
+            found = true;
+        });
+    });
+    if (!found) return false;
+    if (other) {
+        spdlog::debug("TaskstatsCollector: reply does not belong to pid {}, dropped", pid);
+        return false;
+    }
+
+    out.pid              = pid;
+    out.name.assign(ts.ac_comm, strnlen(ts.ac_comm, sizeof(ts.ac_comm)));
+    out.beginTime        = ts.ac_btime;
+    out.utimeUs          = ts.ac_utime;
+    out.stimeUs          = ts.ac_stime;
+    out.nvcsw            = ts.nvcsw;
+    out.nivcsw           = ts.nivcsw;
+    out.cpuDelayCount    = ts.cpu_count;
+    out.cpuDelayNs       = ts.cpu_delay_total;
+    out.blkioDelayCount  = ts.blkio_count;
+    out.blkioDelayNs     = ts.blkio_delay_total;
+    out.swapinDelayCount = ts.swapin_count;
+    out.swapinDelayNs    = ts.swapin_delay_total;
+    out.readBytes        = ts.read_bytes;
+    out.writeBytes       = ts.write_bytes;
+    out.readChar         = ts.read_char;
+    out.writeChar        = ts.write_char;
+    return true;
+}
+
+/* 按 tgid 汇总时内核只累加各线程的计数，ac_btime 恒为 0，PID 复用无从识别；
+   改由 /proc/<pid>/stat 的 starttime 换算。读取失败说明进程已退出，本行丢弃 */
+bool TaskstatsCollector::fillBeginTime(taskstats_info& info) {
+    char* buf = procfs::thread_buffer();
+    procfs::StatFields stat;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        procfs::PidHandle* h = handles_.acquire(info.pid);
+        ssize_t n = -1;
+        if (h) {
+            n = h->read(procfs::PidFile::Stat, buf, procfs::kReadBufSize);
+        } else {
+            char path[32];
+            std::snprintf(path, sizeof(path), "/proc/%d/stat", info.pid);
+            n = procfs::read_file(path, buf, procfs::kReadBufSize);
+        }
+        if (n > 0 && procfs::parse_stat(buf, static_cast<std::size_t>(n), stat)) {
+            info.beginTime = boot_time_ + stat.starttime / static_cast<std::uint64_t>(hz_);
+            return true;
+        }
+        /* 缓存的句柄属于已退出的旧进程（PID 可能已被复用），重新打开一次 */
+        if (!h) return false;
+        handles_.invalidate(info.pid);
+    }
+    return false;
+}
+
+bool TaskstatsCollector::init(const nlohmann::json& cfg) {
+    spdlog::info("TaskstatsCollector init with config: {}", cfg.dump());
+    std::lock_guard lg(mtx_);
+    if (cfg.contains("aggregate"))
+        per_tgid_ = cfg["aggregate"].get<std::string>() != "pid";
+
+    if (sock_ >= 0) return true;
+    hz_ = sysconf(_SC_CLK_TCK);
+    char* buf = procfs::thread_buffer();
+    ssize_t n = procfs::read_file("/proc/stat", buf, procfs::kReadBufSize);
+    if (n <= 0 || !procfs::parse_boot_time(buf, static_cast<std::size_t>(n), boot_time_) || hz_ <= 0) {
+        spdlog::error("TaskstatsCollector: read btime from /proc/stat failed");
+        return false;
+    }
+    if (!openSocket()) return false;
+    if (!resolveFamily()) {
+        spdlog::error("TaskstatsCollector: resolve genetlink family {} failed", TASKSTATS_GENL_NAME);
+        ::close(sock_);
+        sock_ = -1;
+        return false;
+    }
+    spdlog::info("TaskstatsCollector: family id {}, aggregate by {}", family_, per_tgid_ ? "tgid" : "pid");
+    return true;
+}
+
+const Schema& taskstatsSchema() {
+    using namespace cols;
+    static const Schema schema = Schema("taskstats", int8_t(CollectorType::TaskstatsCollector), {
+        Schema::column(kPid), Schema::column(kName), Schema::column(kUtimeUs), Schema::column(kStimeUs),
+        Schema::column(kNvcsw), Schema::column(kNivcsw), Schema::column(kCpuDelayCount),
+        Schema::column(kCpuDelayNs), Schema::column(kBlkioDelayCount), Schema::column(kBlkioDelayNs),
+        Schema::column(kSwapinDelayCount), Schema::column(kSwapinDelayNs), Schema::column(kReadBytes),
+        Schema::column(kWriteBytes), Schema::column(kReadChar), Schema::column(kWriteChar),
+        Schema::column(kBeginTime), Schema::column(kUtimeRate), Schema::column(kStimeRate),
+        Schema::column(kNvcswRate), Schema::column(kNivcswRate), Schema::column(kCpuDelayRate),
+        Schema::column(kBlkioDelayRate), Schema::column(kReadBytesRate), Schema::column(kWriteBytesRate),
+    }).withRates(Schema::rates(kPid, kBeginTime, {
+        Schema::counter(kUtimeUs, kUtimeRate),         Schema::counter(kStimeUs, kStimeRate),
+        Schema::counter(kNvcsw, kNvcswRate),           Schema::counter(kNivcsw, kNivcswRate),
+        Schema::counter(kCpuDelayNs, kCpuDelayRate),   Schema::counter(kBlkioDelayNs, kBlkioDelayRate),
+        Schema::counter(kReadBytes, kReadBytesRate),   Schema::counter(kWriteBytes, kWriteBytesRate),
+    }));
+    return schema;
+}
+
+void TaskstatsCollector::appendRow(SampleBatch& batch, const taskstats_info& info) {
+    using namespace cols;
+    std::size_t r = batch.appendRow();
+    batch.set(r, kPid, info.pid);
+    batch.setInterned(r, kName, info.name);
+    batch.set(r, kUtimeUs, info.utimeUs);
+    batch.set(r, kStimeUs, info.stimeUs);
+    batch.set(r, kNvcsw, info.nvcsw);
+    batch.set(r, kNivcsw, info.nivcsw);
+    batch.set(r, kCpuDelayCount, info.cpuDelayCount);
+    batch.set(r, kCpuDelayNs, info.cpuDelayNs);
+    batch.set(r, kBlkioDelayCount, info.blkioDelayCount);
+    batch.set(r, kBlkioDelayNs, info.blkioDelayNs);
+    batch.set(r, kSwapinDelayCount, info.swapinDelayCount);
+    batch.set(r, kSwapinDelayNs, info.swapinDelayNs);
+    batch.set(r, kReadBytes, info.readBytes);
+    batch.set(r, kWriteBytes, info.writeBytes);
+    batch.set(r, kReadChar, info.readChar);
+    batch.set(r, kWriteChar, info.writeChar);
+    batch.set(r, kBeginTime, info.beginTime);
+}
+
+CollectResult TaskstatsCollector::collect(const Job& job) {
+    auto batch = std::make_shared<SampleBatch>(taskstatsSchema());
+    std::lock_guard lg(mtx_);
+    if (sock_ < 0) return batch;
+
+    batch->reserve(job.JobPIDs.size());
+    taskstats_info info;
+    for (int pid : job.JobPIDs) {
+        if (pid <= 0) continue;
+        if (!query(pid, info)) continue;
+        if (per_tgid_ && !fillBeginTime(info)) continue;
+        appendRow(*batch, info);
+    }
+    rates_.apply(*batch, std::chrono::steady_clock::now());
+    return batch;
+}
+
+std::vector<CollectResult> TaskstatsCollector::collectBatch(const std::vector<JobPtr>& jobs) {
+    /* 本周期所有作业的 PID 合并成一串流水线请求，省去逐个请求的往返等待 */
+    std::vector<int> pids;
+    for (const auto& job : jobs)
+        for (int pid : job->JobPIDs)
+            if (pid > 0) pids.push_back(pid);
+    std::sort(pids.begin(), pids.end());
+    pids.erase(std::unique(pids.begin(), pids.end()), pids.end());
+
+    std::vector<taskstats_info> sampled;
+    std::vector<char> ok;
+    {
+        std::lock_guard lg(mtx_);
+        if (sock_ >= 0) queryMany(pids, sampled, ok);
+        if (per_tgid_)
+            for (std::size_t i = 0; i < ok.size(); ++i)
+                if (ok[i] && !fillBeginTime(sampled[i])) ok[i] = 0;
+    }
+    ok.resize(pids.size(), 0);
+    auto now = std::chrono::steady_clock::now();
+
+    std::vector<CollectResult> results;
+    results.reserve(jobs.size());
+    for (const auto& job : jobs) {
+        auto batch = std::make_shared<SampleBatch>(taskstatsSchema());
+        batch->reserve(job->JobPIDs.size());
+        for (int pid : job->JobPIDs) {
+            if (pid <= 0) continue;
+            auto i = static_cast<std::size_t>(std::lower_bound(pids.begin(), pids.end(), pid) - pids.begin());
+            if (ok[i]) appendRow(*batch, sampled[i]);
+        }
+        rates_.apply(*batch, now);
+        results.emplace_back(std::move(batch));
+    }
+    return results;
+}
+
+void TaskstatsCollector::beginTick(const TickContext&) {
+    rates_.sweep(kIdleTimeout);
+    std::lock_guard lg(mtx_);
+    handles_.sweep(kIdleTimeout);
+}
+
+void TaskstatsCollector::deinit() noexcept {
+    rates_.clear();
+    std::lock_guard lg(mtx_);
+    handles_.clear();
+    if (sock_ >= 0) {
+        spdlog::info("TaskstatsCollector deinit");
+        ::close(sock_);
+        sock_ = -1;
+    }
+}
+
+namespace {
+    struct AutoReg {
+        AutoReg() {
+            CollectorRegistry::instance().registerCollector<TaskstatsCollector>(COLLECTOR_TYPE_TASKSTATS);
+        }
+    };
+    static AutoReg _auto_reg;
+}
+
+} // namespace taskstats_collector
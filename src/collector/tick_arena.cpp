@@ -0,0 +1,115 @@
+#include "collector/tick_arena.hpp"
+
+#include <algorithm>
+
+namespace {
+
+thread_local std::shared_ptr<TickArena> tl_current;
+
+/* 线程首次分配时按轮转分到一个分片 */
+std::size_t threadSlot() {
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+} // namespace
+
+/* ---------- TickArena::Shard ---------- */
+
+TickArena::Shard::Shard() : initial_(new std::byte[kInitialSize]) {
+    mono_.emplace(initial_.get(), initialSize_, std::pmr::new_delete_resource());
+}
+
+void* TickArena::Shard::do_allocate(std::size_t bytes, std::size_t align) {
+    std::lock_guard lg(m_);
+    used_ += bytes;
+    return mono_->allocate(bytes, align);
+}
+
+void TickArena::Shard::reset() {
+    std::lock_guard lg(m_);
+    mono_.reset();   // 把超出初始缓冲区后向上游申请的块还回去
+    if (used_ > initialSize_ && initialSize_ < kMaxInitialSize) {
+        std::size_t size = initialSize_;
+        while (size < used_ && size < kMaxInitialSize) size *= 2;
+        initial_.reset(new std::byte[size]);
+        initialSize_ = size;
+    }
+    used_ = 0;
+    mono_.emplace(initial_.get(), initialSize_, std::pmr::new_delete_resource());
+}
+
+/* ---------- TickArena ---------- */
+
+TickArena::TickArena() = default;
+TickArena::~TickArena() = default;
+
+std::pmr::memory_resource* TickArena::resource() {
+    return &shards_[threadSlot() % kShards];
+}
+
+void TickArena::reset() {
+    for (auto& s : shards_) s.reset();
+}
+
+const std::shared_ptr<TickArena>& TickArena::current() {
+    return tl_current;
+}
+
+TickArena::Scope::Scope(std::shared_ptr<TickArena> arena) : prev_(std::move(tl_current)) {
+    tl_current = std::move(arena);
+}
+
+TickArena::Scope::~Scope() {
+    tl_current = std::move(prev_);
+}
+
+/* ---------- TickArenaPool ---------- */
+
+TickArenaPool& TickArenaPool::instance() {
+    /* 进程退出时写入器可能仍持有批次（其中引用着 arena），池本身不析构 */
+    static auto* pool = new TickArenaPool;
+    return *pool;
+}
+
+std::shared_ptr<TickArena> TickArenaPool::acquire() {
+    std::unique_ptr<TickArena> arena;
+    {
+        std::lock_guard lg(m_);
+        if (!idle_.empty()) {
+            arena = std::move(idle_.back());
+            idle_.pop_back();
+        }
+    }
+    if (!arena) arena = std::make_unique<TickArena>();
+    return std::shared_ptr<TickArena>(arena.release(), [this](TickArena* a) { recycle(a); });
+}
+
+void TickArenaPool::recycle(TickArena* arena) {
+    std::unique_ptr<TickArena> owned(arena);
+    owned->reset();
+    std::lock_guard lg(m_);
+    if (idle_.size() < kMaxIdle) idle_.push_back(std::move(owned));
+}
+
+/* ---------- NameInterner ---------- */
+
+NameInterner& NameInterner::instance() {
+    static auto* interner = new NameInterner;   // 驻留的视图在静态析构之后仍可能被引用
+    return *interner;
+}
+
+std::optional<std::string_view> NameInterner::intern(std::string_view s) {
+    {
+        std::shared_lock lk(m_);
+        auto it = names_.find(s);
+        if (it != names_.end()) return *it;
+        if (names_.size() >= kMaxEntries) return std::nullopt;
+    }
+    std::unique_lock lk(m_);
+    auto it = names_.find(s);   // 释放读锁期间可能已被其他线程驻留
+    if (it != names_.end()) return *it;
+    if (names_.size() >= kMaxEntries) return std::nullopt;
+    return *names_.insert(storage_.emplace_back(s)).first;
+}
@@ -3,14 +3,19 @@
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <sys/epoll.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <atomic>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <spdlog/spdlog.h>
 namespace {
 
@@ -42,6 +47,32 @@ int create_and_bind_tcp(const std::string& host_port) {
     return sock;
 }
 
+int create_and_bind_unix(const std::string& path, unsigned mode) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("unix socket path too long");
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0) throw std::runtime_error("socket");
+    // 上次运行残留的 socket 文件会让 bind 失败
+    ::unlink(path.c_str());
+    /* bind 按 0777 & ~umask 创建 socket 文件；先收紧 umask 使文件一创建就是 mode，
+       避免 bind 之后再 chmod 留下权限过宽的窗口。umask 是进程级的，只在启动阶段调用 */
+    mode_t old_mask = mode != 0 ? ::umask(~mode & 0777) : 0;
+    int rc = bind(sock, (sockaddr*)&addr, sizeof(addr));
+    if (mode != 0) ::umask(old_mask);
+    if (rc < 0) {
+        ::close(sock);
+        throw std::runtime_error("bind");
+    }
+    if (listen(sock, 128) < 0) {
+        ::close(sock);
+        throw std::runtime_error("listen");
+    }
+    return sock;
+}
+
 int open_fifo(const std::string& path) {
     if (mkfifo(path.c_str(), 0666) < 0 && errno != EEXIST)
         throw std::runtime_error("mkfifo");
@@ -62,9 +93,11 @@ int open_file(const std::string& path) {
 
 class StreamWatcher::Impl {
 public:
-    Impl(const Config& cfg, Callback cb) : cfg_(cfg), cb_(std::move(cb)) {
+    Impl(const Config& cfg, RequestCallback cb) : cfg_(cfg), cb_(std::move(cb)) {
         if (cfg_.type == Type::TCP) {
             fd_ = create_and_bind_tcp(cfg_.path);
+        } else if (cfg_.type == Type::UNIX) {
+            fd_ = create_and_bind_unix(cfg_.path, cfg_.mode);
         } else if (cfg_.type == Type::FIFO) {
             fd_ = open_fifo(cfg_.path);
         } else if (cfg_.type == Type::FILE) {
@@ -90,8 +123,10 @@ public:
 
     ~Impl() {
         stop();
+        for (int conn : conns_) ::close(conn);
         ::close(fd_);
         ::close(epoll_fd_);
+        if (cfg_.type == Type::UNIX) ::unlink(cfg_.path.c_str());
     }
 
     void start() {
@@ -120,48 +155,148 @@ public:
 
 private:
     void handle_event(const epoll_event& ev) {
-        if (cfg_.type == Type::TCP) {
+        if (cfg_.type == Type::TCP || cfg_.type == Type::UNIX) {
             if (ev.data.fd == fd_) {
-                // 监听 socket 可读 => 新连接
-                int conn = accept4(fd_, nullptr, nullptr, SOCK_NONBLOCK);
-                if (conn < 0) return;
-                epoll_event new_ev{};
-                new_ev.events = EPOLLIN | EPOLLET; // 边缘触发
-                new_ev.data.fd = conn;
-                epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn, &new_ev);
+                // 监听 socket 可读 => 新连接；边缘触发下要一次接收完所有排队的连接
+                int conn;
+                while ((conn = accept4(fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    if (!authorized(conn)) {
+                        ::close(conn);
+                        continue;
+                    }
+                    epoll_event new_ev{};
+                    new_ev.events = EPOLLIN | EPOLLET; // 边缘触发
+                    new_ev.data.fd = conn;
+                    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn, &new_ev);
+                    conns_.insert(conn);
+                }
                 return;
             }
         }
+        if (cfg_.type == Type::UNIX) {
+            handle_packets(ev.data.fd);
+            return;
+        }
         spdlog::debug("StreamWatcher: enter an event");
-        // 普通数据可读
-        char buf[4096];
-        ssize_t n = read(ev.data.fd, buf, sizeof(buf));
-        if (n <= 0) {
-            if (cfg_.type == Type::TCP) {
-                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, ev.data.fd, nullptr);
-                ::close(ev.data.fd);
+        // 边缘触发：一次唤醒必须读到 EAGAIN 为止，否则剩余数据要等下一次写入才会被处理
+        int fd = ev.data.fd;
+        std::string& pending = pending_[fd];
+        bool eof = false;
+        for (;;) {
+            ssize_t n = read(fd, rbuf_, sizeof(rbuf_));
+            if (n > 0) {
+                pending.append(rbuf_, static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n < 0) spdlog::warn("StreamWatcher: read fd {} failed: {}", fd, strerror(errno));
+            eof = true;
+            break;
+        }
+        spdlog::debug("StreamWatcher: {} bytes pending on fd {}", pending.size(), fd);
+        deliver(pending, eof);
+        if (eof && cfg_.type == Type::TCP) {
+            pending_.erase(fd);
+            close_conn(fd);
+        }
+    }
+
+    /* SOCK_SEQPACKET 保留消息边界：每个包交给回调一次，应答同步写回。
+       客户端等到应答才发下一批，处理速度自然限制了写入速度 */
+    void handle_packets(int fd) {
+        for (;;) {
+            ssize_t n = recv(fd, rbuf_, sizeof(rbuf_), MSG_TRUNC);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            if (n <= 0) {
+                if (n < 0) spdlog::warn("StreamWatcher: recv fd {} failed: {}", fd, strerror(errno));
+                close_conn(fd);
+                return;
+            }
+            std::size_t len = static_cast<std::size_t>(n);
+            if (len > sizeof(rbuf_)) {
+                spdlog::warn("StreamWatcher: {} byte packet on fd {} truncated to {}", len, fd, sizeof(rbuf_));
+                len = sizeof(rbuf_);
+            }
+            std::string reply = cb_(rbuf_, len);
+            if (reply.empty()) continue;
+            if (send(fd, reply.data(), reply.size(), MSG_NOSIGNAL) < 0) {
+                spdlog::warn("StreamWatcher: reply to fd {} failed: {}", fd, strerror(errno));
+                close_conn(fd);
+                return;
+            }
+        }
+    }
+
+    /* 凭据在 connect 时由内核记录，之后不会变化，只需在接受连接时检查一次 */
+    bool authorized(int conn) {
+        if (cfg_.type != Type::UNIX || !cfg_.authorize) return true;
+        ucred cred{};
+        socklen_t len = sizeof(cred);
+        if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) {
+            spdlog::warn("StreamWatcher: SO_PEERCRED on {} failed: {}", cfg_.path, strerror(errno));
+            return false;
+        }
+        if (cfg_.authorize(cred.uid, cred.gid)) return true;
+        spdlog::warn("StreamWatcher: rejected connection on {} from pid {} uid {} gid {}",
+                     cfg_.path, cred.pid, cred.uid, cred.gid);
+        return false;
+    }
+
+    void close_conn(int fd) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        conns_.erase(fd);
+    }
+
+    void deliver(std::string& pending, bool eof) {
+        if (pending.empty()) return;
+        if (cfg_.framing == Framing::Raw || eof) {
+            cb_(pending.data(), pending.size());
+            pending.clear();
+            return;
+        }
+        auto last = pending.rfind('\n');
+        if (last == std::string::npos) {
+            if (pending.size() > kMaxPending) {
+                spdlog::error("StreamWatcher: {} bytes without newline, dropped", pending.size());
+                pending.clear();
             }
             return;
         }
-        spdlog::debug("StreamWatcher: read {} bytes from fd {}", n, ev.data.fd);
-        cb_(buf, static_cast<std::size_t>(n));
+        cb_(pending.data(), last + 1);
+        pending.erase(0, last + 1);
     }
 
+    /* 单条消息的上限，防止对端不发换行时缓冲无限增长 */
+    static constexpr std::size_t kMaxPending = 1 << 20;
+
     Config cfg_;
-    Callback cb_;
+    RequestCallback cb_;
     int fd_;
     int epoll_fd_;
     std::thread thread_;
     std::atomic<bool> stop_flag_{false};
+    char rbuf_[64 * 1024];
+    std::unordered_map<int, std::string> pending_;   // fd -> 尚未凑成完整一行的数据
+    std::unordered_set<int> conns_;                  // 已接受的连接
 };
 
 // public 接口转发
 StreamWatcher::StreamWatcher(const Config& cfg, Callback cb)
+    : StreamWatcher(cfg, RequestCallback([cb = std::move(cb)](const char* buf, std::size_t len) {
+          cb(buf, len);
+          return std::string();
+      })) {}
+
+StreamWatcher::StreamWatcher(const Config& cfg, RequestCallback cb)
     : pImpl_(std::make_unique<Impl>(cfg, std::move(cb))) {
 
     spdlog::info("StreamWatcher: started watching {}",
                 cfg.type == Type::TCP ? ("tcp:" + cfg.path) :
                 cfg.type == Type::FIFO ? ("fifo:" + cfg.path) :
+                cfg.type == Type::UNIX ? ("unix:" + cfg.path) :
                 ("file:" + cfg.path));
     }
 StreamWatcher::~StreamWatcher() = default;
@@ -2,40 +2,26 @@
 #include <iostream>
 #include <spdlog/spdlog.h>
 
-TimerScheduler::TimerScheduler(size_t numWorkers)
-    : stop(false), nextId(0) {
-    for (size_t i = 0; i < numWorkers; ++i) {
-        workers.emplace_back([this] { workerLoop(); });
-    }
+TimerScheduler::TimerScheduler(WorkStealingExecutor& executor)
+    : executor(executor), origin(Clock::now()), stop(false) {
     schedulerThread = std::thread([this] { schedulerLoop(); });
 }
 
 TimerScheduler::~TimerScheduler() {
-    stop = true;
-    cv.notify_all();
-    schedulerCv.notify_all();
-    for (auto& worker : workers) {
-        if (worker.joinable()) {
-            worker.join();
-        }
-    }
-    if (schedulerThread.joinable()) {
-        schedulerThread.join();
-    }
+    shutdown();
 }
 
 void TimerScheduler::shutdown() {
-    stop = true;
-    cv.notify_all();
-    schedulerCv.notify_all();
-    for (auto& worker : workers) {
-        if (worker.joinable()) {
-            worker.join();
-        }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
     }
+    cv.notify_all();
     if (schedulerThread.joinable()) {
         schedulerThread.join();
     }
+    std::unique_lock<std::mutex> lock(inflightMtx);
+    inflightCv.wait(lock, [this] { return inflight == 0; });
 }
 
 size_t TimerScheduler::registerTimer(Duration delay, Task task) {
@@ -48,72 +34,296 @@ size_t TimerScheduler::registerRepeatingTimer(Duration interval, Task task) {
 
 bool TimerScheduler::cancelTimer(size_t id) {
     std::lock_guard<std::mutex> lock(mtx);
-    return taskMap.erase(id) > 0;
+    TimerNode* node = findNode(id);
+    if (!node) return false;
+    /* 任务可能正在取消自己的定时器：已挂起的整点也一并作废，驱动任务执行完当前这次就退出 */
+    if (node->aligned) {
+        std::lock_guard<std::mutex> lg(node->aligned->m);
+        node->aligned->cancelled = true;
+        node->aligned->pending.clear();
+    }
+    unlink(node);
+    releaseNode(node);
+    return true;
+}
+
+TimerScheduler::TimerNode* TimerScheduler::findNode(size_t id) const {
+    size_t index = id & 0xffffffffu;
+    if (id == 0 || index >= nodePool.size()) return nullptr;   // 空闲节点的 id 为 0
+    TimerNode* node = nodePool[index].get();
+    return node->id == id ? node : nullptr;   // 代号不符说明节点已被回收复用
+}
+
+void TimerScheduler::releaseNode(TimerNode* node) {
+    freeNodes.push_back(static_cast<uint32_t>(node->id & 0xffffffffu));
+    node->id = 0;
+    node->task.reset();
+    node->aligned.reset();
+    --activeCount;
+}
+
+TimerScheduler::TimerNode* TimerScheduler::allocNode() {
+    uint32_t index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodePool.size());
+        nodePool.push_back(std::make_unique<TimerNode>());
+    }
+    if (++generation == 0) ++generation;   // 代号从不为 0，保证 id 非 0
+    TimerNode* node = nodePool[index].get();
+    node->id = (static_cast<size_t>(generation) << 32) | index;
+    ++activeCount;
+    return node;
 }
 
 size_t TimerScheduler::addTask(Task task, Duration interval, bool repeat) {
+    if (repeat && interval.count() <= 0) interval = Duration(1);
+
     std::lock_guard<std::mutex> lock(mtx);
-    auto id = nextId++;
-    auto now = Clock::now();
-    TimerTask timerTask{now + interval, interval, std::move(task), repeat, id};
+    TimerNode* node = allocNode();
+    node->interval = interval;
+    node->repeat   = repeat;
+    node->task     = std::make_shared<const Task>(std::move(task));
+    /* 向上取整到 tick，且至少在下一个 tick，保证不早于请求的时间触发 */
+    node->expire   = std::max(toTick(Clock::now() + interval), currentTick + 1);
 
-    taskMap[id] = timerTask;
-    tasks.push(timerTask);
+    link(node);
     cv.notify_one();
-    return id;
+    return node->id;
 }
 
-void TimerScheduler::schedulerLoop() {
-    while (!stop) {
-        std::unique_lock<std::mutex> lock(mtx);
-        if (tasks.empty()) {
-            cv.wait(lock, [this] { return stop || !tasks.empty(); });
-            if (stop) break;
+namespace {
+using WallClock = std::chrono::system_clock;
+
+/* now 之后（含）的第一个 interval 整数倍 */
+WallClock::time_point nextBoundary(WallClock::time_point now, TimerScheduler::Duration interval) {
+    auto ms = std::chrono::duration_cast<TimerScheduler::Duration>(now.time_since_epoch()).count();
+    auto step = interval.count();
+    auto boundary = (ms + step - 1) / step * step;
+    return WallClock::time_point(TimerScheduler::Duration(boundary));
+}
+} // namespace
+
+bool TimerScheduler::parsePolicy(const std::string& name, MissedTickPolicy& out) {
+    if (name == "skip")          out = MissedTickPolicy::Skip;
+    else if (name == "coalesce") out = MissedTickPolicy::Coalesce;
+    else if (name == "catch_up") out = MissedTickPolicy::CatchUp;
+    else return false;
+    return true;
+}
+
+size_t TimerScheduler::registerAlignedTimer(Duration interval, MissedTickPolicy policy, TickTask task) {
+    if (interval.count() <= 0) interval = Duration(1);
+
+    auto state = std::make_shared<AlignedState>();
+    state->policy = policy;
+    state->task   = std::move(task);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    TimerNode* node = allocNode();
+    node->interval = interval;
+    node->repeat   = true;
+    node->aligned  = state;
+    /* 驱动任务：依次执行挂起的整点，同一定时器同时最多一个驱动任务在跑 */
+    node->task = std::make_shared<const Task>([state] {
+        for (;;) {
+            Tick tick;
+            {
+                std::lock_guard<std::mutex> lg(state->m);
+                if (state->cancelled || state->pending.empty()) {
+                    state->pending.clear();
+                    state->running = false;
+                    return;
+                }
+                tick = state->pending.front();
+                state->pending.pop_front();
+            }
+            try {
+                state->task(tick);
+            } catch (const std::exception& e) {
+                spdlog::error("TimerScheduler: Task execution failed: {}",e.what());
+            }
         }
+    });
 
-        auto now = Clock::now();
-        if (!tasks.empty() && tasks.top().nextRun <= now) {
-            auto task = tasks.top();
-            tasks.pop();
-            lock.unlock();
+    auto wallNow = WallClock::now();
+    state->nextWall = nextBoundary(wallNow, interval);
+    node->expire = std::max(toTick(Clock::now() + (state->nextWall - wallNow)), currentTick + 1);
+
+    link(node);
+    cv.notify_one();
+    return node->id;
+}
+
+/* 对齐定时器到期：按策略登记本次要执行的整点并重新挂到时间轮上；返回是否需要派发驱动任务 */
+bool TimerScheduler::fireAligned(TimerNode* node, uint64_t tick) {
+    auto& st = *node->aligned;
+    auto wallNow = WallClock::now();
+    auto interval = std::chrono::duration_cast<WallClock::duration>(node->interval);
 
-            taskQueue.push(task.task);
-            schedulerCv.notify_one();
+    /* 调度被推迟（或墙上时间前跳）时可能已经越过了多个整点 */
+    uint64_t missed = wallNow > st.nextWall ? static_cast<uint64_t>((wallNow - st.nextWall) / interval) : 0;
+    auto latest = st.nextWall + interval * missed;
 
-            if (task.repeat) {
-                task.nextRun = now + task.interval;
-                lock.lock();
-                if (taskMap.count(task.id)) {
-                    tasks.push(task);
+    bool start = false;
+    {
+        std::lock_guard<std::mutex> lg(st.m);
+        switch (st.policy) {
+            case MissedTickPolicy::Skip:
+                if (st.running) {
+                    st.dropped += missed + 1;
+                } else {
+                    st.pending.push_back(Tick{latest, missed + st.dropped});
+                    st.dropped = 0;
                 }
-                lock.unlock();
+                break;
+            case MissedTickPolicy::Coalesce:
+                if (st.pending.empty()) st.pending.push_back(Tick{latest, missed});
+                else st.pending.back() = Tick{latest, st.pending.back().missed + missed + 1};
+                break;
+            case MissedTickPolicy::CatchUp:
+                for (uint64_t k = missed > kMaxCatchUp ? missed - kMaxCatchUp : 0; k <= missed; ++k)
+                    st.pending.push_back(Tick{st.nextWall + interval * k, 0});
+                while (st.pending.size() > kMaxCatchUp) st.pending.pop_front();
+                break;
+        }
+        if (!st.running && !st.pending.empty()) {
+            st.running = true;
+            start = true;
+        }
+    }
+
+    /* 下一个整点由本次整点推算；墙上时间被往回调时重新对齐，避免长时间停摆 */
+    st.nextWall = latest + interval;
+    if (st.nextWall - wallNow > interval * 2) st.nextWall = nextBoundary(wallNow, node->interval);
+    node->expire = std::max(toTick(Clock::now() + (st.nextWall - wallNow)), tick + 1);
+    link(node);
+    return start;
+}
+
+uint64_t TimerScheduler::toTick(TimePoint tp) const {
+    if (tp <= origin) return 0;
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(tp - origin).count();
+    return static_cast<uint64_t>((us + 999) / 1000);
+}
+
+void TimerScheduler::link(TimerNode* node) {
+    /* 选最低的层级 l，使到期 tick 与当前 tick 在 l 以上的位完全相同 */
+    TimerNode** head = &overflow;
+    for (int level = 0; level < kLevels; ++level) {
+        int shift = kSlotBits * (level + 1);
+        if ((node->expire >> shift) == (currentTick >> shift)) {
+            head = &wheel[level][(node->expire >> (kSlotBits * level)) & kSlotMask];
+            break;
+        }
+    }
+    node->next  = *head;
+    node->pprev = head;
+    if (*head) (*head)->pprev = &node->next;
+    *head = node;
+}
+
+void TimerScheduler::unlink(TimerNode* node) {
+    if (!node->pprev) return;
+    *node->pprev = node->next;
+    if (node->next) node->next->pprev = node->pprev;
+    node->next  = nullptr;
+    node->pprev = nullptr;
+}
+
+void TimerScheduler::cascade(int level, uint64_t index) {
+    TimerNode* node = level < kLevels ? wheel[level][index] : overflow;
+    if (level < kLevels) wheel[level][index] = nullptr;
+    else overflow = nullptr;
+    while (node) {
+        TimerNode* next = node->next;
+        node->pprev = nullptr;
+        link(node);
+        node = next;
+    }
+}
+
+void TimerScheduler::advance(uint64_t target) {
+    while (currentTick < target) {
+        uint64_t tick = ++currentTick;
+
+        /* 低位回绕时，把上一级当前槽的任务重新分配到更低的层级（先高后低） */
+        for (int level = kLevels; level >= 1; --level) {
+            uint64_t lowMask = (uint64_t(1) << (kSlotBits * level)) - 1;
+            if ((tick & lowMask) != 0) continue;
+            cascade(level, level < kLevels ? (tick >> (kSlotBits * level)) & kSlotMask : 0);
+        }
+
+        TimerNode* node = wheel[0][tick & kSlotMask];
+        wheel[0][tick & kSlotMask] = nullptr;
+        while (node) {
+            TimerNode* next = node->next;
+            node->next  = nullptr;
+            node->pprev = nullptr;
+            if (node->aligned) {
+                if (fireAligned(node, tick)) due.push_back(node->task);
+                node = next;
+                continue;
+            }
+            due.push_back(node->task);
+            if (node->repeat) {
+                node->expire = tick + static_cast<uint64_t>(node->interval.count());
+                link(node);
             } else {
-                lock.lock();
-                taskMap.erase(task.id);
+                releaseNode(node);
             }
-        } else {
-            cv.wait_until(lock, tasks.top().nextRun);
+            node = next;
         }
     }
 }
 
-void TimerScheduler::workerLoop() {
+uint64_t TimerScheduler::nextWakeTick() const {
+    /* 只在最低一级内查找；找不到就醒在下一次回绕，届时会有更高层级的任务落下来 */
+    uint64_t wrap = (currentTick | kSlotMask) + 1;
+    for (uint64_t t = currentTick + 1; t < wrap; ++t)
+        if (wheel[0][t & kSlotMask]) return t;
+    return wrap;
+}
+
+void TimerScheduler::dispatch(const std::shared_ptr<const Task>& task) {
+    {
+        std::lock_guard<std::mutex> lock(inflightMtx);
+        ++inflight;
+    }
+    executor.submit([this, task] {
+        try {
+            (*task)();
+        } catch (const std::exception& e) {
+            spdlog::error("TimerScheduler: Task execution failed: {}",e.what());
+        }
+        std::lock_guard<std::mutex> lock(inflightMtx);
+        if (--inflight == 0) inflightCv.notify_all();
+    });
+}
+
+void TimerScheduler::schedulerLoop() {
+    std::vector<std::shared_ptr<const Task>> ready;
+    std::unique_lock<std::mutex> lock(mtx);
     while (!stop) {
-        std::unique_lock<std::mutex> lock(queueMtx);
-        schedulerCv.wait(lock, [this] { return stop || !taskQueue.empty(); });
-        if (stop) break;
+        /* now 向下取整：只处理已经完整经过的 tick */
+        auto elapsed = std::chrono::duration_cast<Duration>(Clock::now() - origin).count();
+        advance(static_cast<uint64_t>(std::max<int64_t>(elapsed, 0)));
 
-        if (!taskQueue.empty()) {
-            auto task = std::move(taskQueue.front());
-            taskQueue.pop();
+        if (!due.empty()) {
+            ready.swap(due);
             lock.unlock();
+            for (auto& task : ready) dispatch(task);
+            ready.clear();
+            lock.lock();
+            continue;
+        }
 
-            try {
-                task();
-            } catch (const std::exception& e) {
-                spdlog::error("TimerScheduler: Task execution failed: {}",e.what());
-                // std::cerr << "Task execution failed: " << e.what() << std::endl;
-            }
+        if (activeCount == 0) {
+            cv.wait(lock, [this] { return stop || activeCount > 0; });
+        } else {
+            cv.wait_until(lock, origin + Duration(nextWakeTick()));
         }
     }
-}
\ No newline at end of file
+}
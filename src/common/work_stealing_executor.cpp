@@ -0,0 +1,174 @@
+#include "common/work_stealing_executor.hpp"
+#include "common/config.hpp"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace {
+/* 当前线程所属的执行器及其队列下标，非工作线程为 nullptr */
+thread_local const WorkStealingExecutor* tl_owner = nullptr;
+thread_local std::size_t                 tl_index = 0;
+} // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(std::size_t numWorkers) {
+    numWorkers = std::max<std::size_t>(numWorkers, 1);
+    for (std::size_t i = 0; i < numWorkers; ++i)
+        queues_.emplace_back(std::make_unique<WorkQueue>());
+    for (std::size_t i = 0; i < numWorkers; ++i)
+        threads_.emplace_back([this, i] { workerLoop(i); });
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() { shutdown(); }
+
+WorkStealingExecutor& WorkStealingExecutor::instance() {
+    static WorkStealingExecutor executor([] {
+        std::size_t threads = 4;
+        try {
+            threads = static_cast<std::size_t>(Config::instance().getInt("lens_config", "max_collector_threads"));
+        } catch (const std::exception& e) {
+            spdlog::warn("WorkStealingExecutor: lens_config.max_collector_threads not set, default {}", threads);
+        }
+        spdlog::info("WorkStealingExecutor: starting {} workers", std::max<std::size_t>(threads, 1));
+        return threads;
+    }());
+    return executor;
+}
+
+WorkStealingExecutor& WorkStealingExecutor::writerInstance() {
+    static WorkStealingExecutor executor([] {
+        std::size_t threads = 1;
+        try {
+            threads = static_cast<std::size_t>(Config::instance().getInt("writers_config", "flush_threads"));
+        } catch (const std::exception& e) {
+            spdlog::debug("WorkStealingExecutor: writers_config.flush_threads not set, default {}", threads);
+        }
+        spdlog::info("WorkStealingExecutor: starting {} writer flush workers", std::max<std::size_t>(threads, 1));
+        return threads;
+    }());
+    return executor;
+}
+
+void WorkStealingExecutor::shutdown() {
+    {
+        std::lock_guard lg(parkMtx_);
+        if (stop_) return;
+        stop_ = true;
+    }
+    parkCv_.notify_all();
+    for (auto& t : threads_)
+        if (t.joinable()) t.join();
+
+    /* 与关闭竞争、在工作线程退出后才入队的任务，在这里补执行 */
+    for (auto& wq : queues_) {
+        std::deque<Task> left;
+        {
+            std::lock_guard lg(wq->m);
+            left.swap(wq->q);
+        }
+        for (auto& task : left) run(task);
+    }
+}
+
+void WorkStealingExecutor::submit(Task task) {
+    if (stop_) {
+        run(task);
+        return;
+    }
+    std::size_t idx = tl_owner == this ? tl_index : next_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard lg(queues_[idx]->m);
+        queues_[idx]->q.push_back(std::move(task));
+    }
+    /* 与 workerLoop 中 “先登记休眠再检查 pending_” 配对：两边至少有一方看到对方的写入 */
+    pending_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        std::lock_guard lg(parkMtx_);
+        parkCv_.notify_one();
+    }
+}
+
+bool WorkStealingExecutor::popLocal(std::size_t self, Task& out) {
+    auto& wq = *queues_[self];
+    std::lock_guard lg(wq.m);
+    if (wq.q.empty()) return false;
+    out = std::move(wq.q.back());
+    wq.q.pop_back();
+    return true;
+}
+
+bool WorkStealingExecutor::steal(std::size_t self, Task& out) {
+    for (std::size_t k = 1; k < queues_.size(); ++k) {
+        auto& wq = *queues_[(self + k) % queues_.size()];
+        std::unique_lock lk(wq.m, std::try_to_lock);   // 对方正忙就换下一个，不排队等锁
+        if (!lk.owns_lock() || wq.q.empty()) continue;
+        out = std::move(wq.q.front());
+        wq.q.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingExecutor::run(Task& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        spdlog::error("WorkStealingExecutor: task execution failed: {}", e.what());
+    }
+}
+
+void WorkStealingExecutor::workerLoop(std::size_t self) {
+    tl_owner = this;
+    tl_index = self;
+    for (;;) {
+        Task task;
+        if (popLocal(self, task) || steal(self, task)) {
+            pending_.fetch_sub(1);
+            run(task);
+            continue;
+        }
+        std::unique_lock lk(parkMtx_);
+        if (stop_ && pending_.load() == 0) return;   // 关闭时先把队列跑空
+        ++sleepers_;
+        parkCv_.wait(lk, [this] { return stop_ || pending_.load() > 0; });
+        --sleepers_;
+    }
+}
+
+void WorkStealingExecutor::parallelFor(std::size_t n, const std::function<void(std::size_t)>& fn) {
+    if (n == 0) return;
+    if (n == 1) {
+        fn(0);
+        return;
+    }
+
+    /* 下标由各参与者原子地领取；辅助任务可能晚于本函数返回才被执行，故状态用 shared_ptr 持有 */
+    struct State {
+        std::atomic<std::size_t> next{0};
+        std::size_t              done{0};
+        std::mutex               mtx;
+        std::condition_variable  cv;
+    };
+    auto st = std::make_shared<State>();
+    auto work = [st, n, &fn] {
+        std::size_t finished = 0;
+        for (std::size_t i; (i = st->next.fetch_add(1)) < n; ++finished) {
+            try {
+                fn(i);
+            } catch (const std::exception& e) {
+                spdlog::error("WorkStealingExecutor: parallel task {} failed: {}", i, e.what());
+            }
+        }
+        if (finished == 0) return;
+        std::lock_guard lg(st->mtx);
+        st->done += finished;
+        if (st->done == n) st->cv.notify_all();
+    };
+
+    std::size_t helpers = std::min(queues_.size(), n - 1);
+    for (std::size_t i = 0; i < helpers; ++i) submit(work);
+    work();
+
+    /* 剩下的只是其他线程已领取、正在执行的下标 */
+    std::unique_lock lk(st->mtx);
+    st->cv.wait(lk, [&] { return st->done == n; });
+}
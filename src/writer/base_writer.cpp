@@ -1,5 +1,6 @@
 #include "writer/base_writer.hpp"
 #include <fmt/core.h>   // 仅在实现文件真正用到 fmt
+#include "common/work_stealing_executor.hpp"
 
 // 内部类型完整定义
 struct base_writer::Buffer
@@ -18,8 +19,7 @@ base_writer::base_writer(std::string name, std::string type, std::string config_
       config_name_(std::move(config_name)),
       buf_capacity_(Config::instance().getInt("writers_config", "buffer_capacity")),
       front_(std::make_unique<Buffer>(buf_capacity_)),
-      back_(std::make_unique<Buffer>(buf_capacity_)),
-      flush_thread_(&base_writer::flush_worker, this)
+      back_(std::make_unique<Buffer>(buf_capacity_))
 {
 }
 
@@ -29,30 +29,39 @@ base_writer::~base_writer()
         std::lock_guard lg(mtx_);
         stop_ = true;
     }
-    cv_.notify_one();
-    if (flush_thread_.joinable())
-        flush_thread_.join();
+    wait_flush_idle();
+    flush_buffer(*front_);
+}
 
+void base_writer::shutdown()
+{
+    {
+        std::lock_guard lg(mtx_);
+        stop_ = true;
+    }
+    spdlog::info("base_writer: shutting down...");
+    wait_flush_idle();
     flush_buffer(*front_);
+    front_->clear();
+    spdlog::info("base_writer: shutdown complete for writer '{}'", name_);
 }
 
 // -------------------- 公有接口 --------------------
 void base_writer::on_finish(std::string collect_name,
-                            const Job& job,
-                            const std::any data,
+                            JobPtr job,
+                            CollectResult data,
                             std::chrono::system_clock::time_point ts)
 {
     spdlog::debug("base_writer: on_finish called for writer '{}', collector '{}'", name_, collect_name);
-    auto t = std::make_tuple(std::move(collect_name), job, data, ts);
-    write(t);
+    write(write_data(std::move(collect_name), std::move(job), std::move(data), ts));
     trigger_async_flush();
 }
 
 OnFinish base_writer::get_onFinishCallback()
 {
     return [this](const std::string& collect_name,
-                  const Job& job,
-                  const std::any data,
+                  const JobPtr& job,
+                  const CollectResult& data,
                   std::chrono::system_clock::time_point ts)
     { on_finish(collect_name, job, data, ts); };
 }
@@ -66,31 +75,47 @@ void base_writer::flush_impl(const std::vector<write_data>&)
 void base_writer::write(const write_data& t)
 {
     spdlog::debug("base_writer: write called for writer '{}', collector '{}'", name_, std::get<0>(t));
-    front_->push_back(t);
-    if (front_->size() >= buf_capacity_)
+    bool full = false;
+    {
+        /* 多个采集线程并发写入，且 flush 线程会交换 front_/back_ */
+        std::lock_guard lg(mtx_);
+        front_->push_back(t);
+        full = front_->size() >= buf_capacity_;
+    }
+    if (full)
         trigger_async_flush();
 }
 
-void base_writer::flush_worker()
+/* 在写入器专用的执行器上运行（ES 等写入会阻塞在网络上，不能占用采集线程）；
+   同一写入器同一时刻最多一个，因此 back_ 只被它访问 */
+void base_writer::flush_task()
 {
-    std::unique_lock<std::mutex> lk(mtx_);
-    while (stop_ == false)
+    spdlog::debug("base_writer: flush task running for writer '{}'", name_);
     {
-        cv_.wait(lk, [this] { return stop_ || need_flush_; });
-        spdlog::debug("base_writer: flush worker woke up for writer '{}'", name_);
-        if (stop_){
-            spdlog::info("base_writer: flush worker stopping...");
-            break;
-        }
-
+        std::lock_guard lg(mtx_);
         front_.swap(back_);
-        need_flush_ = false;
-        lk.unlock();
+    }
 
-        flush_buffer(*back_);
-        back_->clear();
-        lk.lock();
+    flush_buffer(*back_);
+    back_->clear();
+
+    /* 刷新期间到达的数据的触发被合并掉了，这里接着再刷一次。
+       只在锁内清除标志并通知：之后析构函数可能立即返回，不能再访问 this */
+    {
+        std::lock_guard lg(mtx_);
+        if (stop_ || front_->size() == 0) {
+            flush_scheduled_ = false;
+            cv_.notify_all();
+            return;
+        }
     }
+    WorkStealingExecutor::writerInstance().submit([this] { flush_task(); });
+}
+
+void base_writer::wait_flush_idle()
+{
+    std::unique_lock lk(mtx_);
+    cv_.wait(lk, [this] { return !flush_scheduled_; });
 }
 
 void base_writer::flush_buffer(Buffer& buf)
@@ -107,7 +132,8 @@ void base_writer::trigger_async_flush()
 {
     {
         std::lock_guard lg(mtx_);
-        need_flush_ = true;
+        if (stop_ || flush_scheduled_) return;
+        flush_scheduled_ = true;
     }
-    cv_.notify_one();
-}
\ No newline at end of file
+    WorkStealingExecutor::writerInstance().submit([this] { flush_task(); });
+}
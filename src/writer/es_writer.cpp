@@ -6,7 +6,7 @@
 #include <date/date.h>
 #include "common/config.hpp"
 #include "collector/collector_utils.hpp"
-#include "collector/proc_collector_func.hpp"
+#include "collector/sample_batch.hpp"
 
 using json = nlohmann::json;
 
@@ -29,6 +29,29 @@ ESWriter::ESWriter(std::string name, std::string type, std::string config_name)
         opt_.index_prefix = "collector";
         spdlog::warn("elasticsearch_writer: no index_prefix configured, using default 'collector'");
     }
+    /* 采集器 -> 索引映射只在构造时读取，之后只读，多个 flush 任务可并发查询 */
+    try
+    {
+        struct es_index_config
+        {
+            std::string collector_name;
+            std::string index_name;
+        };
+        auto config_indexs = Config::instance().getArray<es_index_config>(
+            config_name, "indexs",
+            [](const YAML::Node& node) {
+                es_index_config c;
+                c.collector_name = node["collector_name"].as<std::string>();
+                c.index_name = node["index_name"].as<std::string>();
+                return c;
+            });
+        for (auto& c : config_indexs)
+            index_names_.emplace(std::move(c.collector_name), std::move(c.index_name));
+    }
+    catch(const std::exception& e)
+    {
+        spdlog::warn("elasticsearch_writer: no indexs configured, using '<index_prefix>_<collector>'");
+    }
     spdlog::debug("elasticsearch_writer: initializing curl...");
     curl_global_init(CURL_GLOBAL_ALL);
     spdlog::debug("elasticsearch_writer: curl_global_init done");
@@ -100,69 +123,50 @@ void ESWriter::write(const write_data& w)
     }
 }
 
-std::string ESWriter::try_get_index_name(const write_data& w)
+std::string ESWriter::try_get_index_name(const write_data& w) const
 {
-    static std::string last_index_name = "default";
-    static std::string last_collector_name = "";
-    if (std::get<0>(w) == last_collector_name)
-        return last_index_name;
-    last_collector_name = std::get<0>(w);
-    struct es_index_config
-    {
-        std::string collector_name;
-        std::string index_name;
-    };
-    static const auto config_indexs = Config::instance().getArray<es_index_config>(
-        config_name_, "indexs",
-        [](const YAML::Node& node) {
-            es_index_config c;
-            c.collector_name = node["collector_name"].as<std::string>();
-            c.index_name = node["index_name"].as<std::string>();
-            return c;
-        });
-        
-    for (const auto& c : config_indexs) {
-        if (c.collector_name == last_collector_name) {
-            last_index_name = c.index_name;
-            return last_index_name;
-        }
-    }
+    auto it = index_names_.find(std::get<0>(w));
+    if (it != index_names_.end())
+        return it->second;
     return "default";
 }
 
-bool ESWriter::try_parse_data(const std::string& collector_name, const std::any& data, json& out)
+/* 按 Schema 把一行转换为文档；子表（如线程）按父行嵌套为数组 */
+static json row_to_json(const SampleBatch& batch, std::size_t row)
 {
-    auto type = collector_utils::get_type_from_name(collector_name);
-    if (type.compare(COLLECTOR_TYPE_PROC) == 0) {
-        try {
-            if(data.has_value() == false) {
-                spdlog::warn("elasticsearch_writer: empty data for collector '{}'", collector_name);
-                return false;
-            }
-            auto parsed = std::any_cast<std::vector<std::shared_ptr<proc_collector::proc_info>>>(data);
-            for (const auto& info : parsed) {
-                json j;
-                j["type"] = info->type;
-                j["pid"] = info->pid;
-                j["name"] = info->name;
-                j["ppid"] = info->ppid;
-                j["cpuPercent"] = info->cpuPercent;
-                j["memoryRss"] = info->memoryRss;
-                j["memoryPercent"] = info->memoryPercent;
-                j["numThreads"] = info->numThreads;
-                j["ioReadCount"] = info->ioReadCount;
-                j["ioWriteCount"] = info->ioWriteCount;
-                j["netConnCount"] = info->netConnCount;
-                j["status"] = info->status;
-                out.push_back(j);
-            }
-            return true;
+    json j;
+    const auto& schema = batch.schema();
+    if (schema.collectorType() >= 0) j["type"] = schema.collectorType();
+    const auto& columns = schema.columns();
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+        const auto& col = batch.data(c);
+        switch (columns[c].type) {
+            case ColumnType::Int64:  j[columns[c].name] = std::get<std::pmr::vector<std::int64_t>>(col)[row]; break;
+            case ColumnType::UInt64: j[columns[c].name] = std::get<std::pmr::vector<std::uint64_t>>(col)[row]; break;
+            case ColumnType::Double: j[columns[c].name] = std::get<std::pmr::vector<double>>(col)[row]; break;
+            case ColumnType::String: j[columns[c].name] = std::string(std::get<std::pmr::vector<std::string_view>>(col)[row]); break;
+            case ColumnType::Bool:   j[columns[c].name] = std::get<std::pmr::vector<std::uint8_t>>(col)[row] != 0; break;
         }
-        catch (const std::bad_any_cast& e) {
-            spdlog::error("elasticsearch_writer: bad_any_cast for collector '{}': {}", collector_name, e.what());
+    }
+    if (const auto* child = batch.child()) {
+        auto [begin, end] = batch.childRange(row);
+        if (begin < end) {
+            json rows = json::array();
+            for (std::size_t r = begin; r < end; ++r) rows.push_back(row_to_json(*child, r));
+            j[schema.childName()] = std::move(rows);
         }
     }
-    return false;
+    return j;
+}
+
+bool ESWriter::try_parse_data(const std::string& collector_name, const CollectResult& data, json& out)
+{
+    if (!data) {
+        spdlog::warn("elasticsearch_writer: empty data for collector '{}'", collector_name);
+        return false;
+    }
+    for (std::size_t r = 0; r < data->rows(); ++r) out.push_back(row_to_json(*data, r));
+    return true;
 }
 
 /* ---------- 真正写 ES ---------- */
@@ -171,10 +175,11 @@ void ESWriter::flush_impl(const std::vector<write_data>& batch)
     if (batch.empty()) return;
 
     std::ostringstream body;
-    for (const auto& [collect_name, job, any_data, ts] : batch)
+    for (const auto& w : batch)
     {
+        const auto& [collect_name, job, data, ts] = w;
         json action;
-        auto index_name = try_get_index_name(batch[0]);
+        auto index_name = try_get_index_name(w);
         if (index_name != "default") {
             action["index"]["_index"] = index_name;
         } else {
@@ -188,7 +193,7 @@ void ESWriter::flush_impl(const std::vector<write_data>& batch)
         src["collector_name"] = collect_name;
         src["hostname"] = collector_utils::get_hostname();
         json jobj;
-        try_parse_data(collect_name, any_data, jobj);
+        try_parse_data(collect_name, data, jobj);
         spdlog::debug("elasticsearch_writer: document to index: {}", jobj.dump());
         src["data"] = jobj;
         body << src.dump() << '\n';
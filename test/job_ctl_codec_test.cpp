@@ -0,0 +1,277 @@
+// job_ctl 请求包解码的单元测试：构造各种完整 / 损坏的记录，检查每条记录的 ack 与解码出的请求
+#include "collector/job_ctl_codec.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                          \
+        }                                                                        \
+    } while (0)
+
+struct RecSpec {
+    std::uint16_t            op{JL_OP_ADD};
+    std::int32_t             job_id{1};
+    std::uint32_t            seq{0};
+    std::uint32_t            flags{JL_F_PIDS | JL_F_LENS};
+    std::vector<std::int32_t> pids{100};
+    std::string              lens{std::string("proc_collector") + '\0'};   // 原样写入的 lens 字节
+    double                   freq{0};
+    std::int64_t             create_time{0};
+    long                     len_delta{0};   // 叠加到正确的 len 上，用于构造长度不符
+};
+
+std::string encode(const RecSpec& s) {
+    jl_rec_hdr h{};
+    h.magic       = JL_MAGIC;
+    h.version     = JL_VERSION;
+    h.op          = s.op;
+    h.seq         = s.seq;
+    h.job_id      = s.job_id;
+    h.flags       = s.flags;
+    h.n_pids      = static_cast<std::uint32_t>(s.pids.size());
+    h.lens_bytes  = static_cast<std::uint32_t>(s.lens.size());
+    h.freq        = s.freq;
+    h.create_time = s.create_time;
+    std::size_t len = sizeof(h) + s.pids.size() * sizeof(std::int32_t) + s.lens.size();
+    h.len = static_cast<std::uint32_t>(static_cast<long>(len) + s.len_delta);
+
+    std::string out(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.append(reinterpret_cast<const char*>(s.pids.data()), s.pids.size() * sizeof(std::int32_t));
+    out += s.lens;
+    return out;
+}
+
+std::vector<job_ctl::Record> decode(const std::string& pkt) {
+    return job_ctl::decode(pkt.data(), pkt.size());
+}
+
+void testValidRecords() {
+    RecSpec add;
+    add.seq = 7;
+    add.job_id = 42;
+    add.pids = {100, 200};
+    add.lens = std::string("proc_collector") + '\0' + "smaps_collector" + '\0';
+    add.flags |= JL_F_FREQ | JL_F_CTIME;
+    add.freq = 2.5;
+    add.create_time = 1700000000;
+
+    RecSpec rm;
+    rm.op = JL_OP_REMOVE;
+    rm.seq = 8;
+    rm.job_id = 43;
+    rm.flags = 0;
+    rm.pids.clear();
+    rm.lens.clear();
+
+    RecSpec attach;
+    attach.op = JL_OP_ATTACH;
+    attach.seq = 9;
+    attach.job_id = 42;
+    attach.flags = JL_F_PIDS;
+    attach.pids = {300};
+    attach.lens.clear();
+
+    auto recs = decode(encode(add) + encode(rm) + encode(attach));
+    CHECK(recs.size() == 3);
+    if (recs.size() != 3) return;
+
+    CHECK(recs[0].ack.status == JL_OK && recs[0].ack.seq == 7 && recs[0].ack.job_id == 42);
+    CHECK(recs[0].req && recs[0].req->kind == job_ctl::Request::Kind::Add);
+    if (recs[0].req) {
+        const Job& job = recs[0].req->job;
+        CHECK(job.JobID == 42);
+        CHECK((job.JobPIDs == std::vector<int>{100, 200}));
+        CHECK((job.CollectorNames == std::vector<std::string>{"proc_collector", "smaps_collector"}));
+        CHECK(job.SampleFreq == 2.5);
+        CHECK(std::chrono::duration_cast<std::chrono::seconds>(job.JobCreateTime.time_since_epoch()).count() ==
+              1700000000);
+    }
+
+    CHECK(recs[1].ack.status == JL_OK && recs[1].ack.seq == 8);
+    CHECK(recs[1].req && recs[1].req->kind == job_ctl::Request::Kind::Remove && recs[1].req->job.JobID == 43);
+
+    CHECK(recs[2].ack.status == JL_OK && recs[2].ack.seq == 9);
+    CHECK(recs[2].req && recs[2].req->kind == job_ctl::Request::Kind::Update);
+    if (recs[2].req) {
+        const JobUpdate& u = recs[2].req->update;
+        CHECK(u.JobID == 42 && u.mode == JobUpdate::Mode::Attach);
+        CHECK(u.JobPIDs && (*u.JobPIDs == std::vector<int>{300}));
+        CHECK(!u.CollectorNames && !u.SampleFreq);
+    }
+}
+
+void testTruncatedHeader() {
+    std::string pkt = encode(RecSpec{});
+    auto recs = decode(pkt.substr(0, sizeof(jl_rec_hdr) - 1));
+    CHECK(recs.size() == 1);
+    CHECK(!recs.empty() && recs[0].ack.status == JL_E_PROTO && !recs[0].req);
+
+    /* 合法记录之后跟着半个头部：前一条照常，后一条 PROTO */
+    RecSpec first;
+    first.seq = 1;
+    recs = decode(encode(first) + pkt.substr(0, 10));
+    CHECK(recs.size() == 2);
+    CHECK(recs.size() == 2 && recs[0].ack.status == JL_OK && recs[1].ack.status == JL_E_PROTO);
+}
+
+void testLengthMismatch() {
+    RecSpec ok1, bad, ok2;
+    ok1.seq = 1;
+    bad.seq = 2;
+    bad.len_delta = 4;   // len 比头部与载荷之和多 4 字节
+    ok2.seq = 3;
+    auto recs = decode(encode(ok1) + encode(bad) + encode(ok2));
+    /* 长度不可信时后续记录无法定位，整包到此为止 */
+    CHECK(recs.size() == 2);
+    CHECK(recs.size() == 2 && recs[0].ack.status == JL_OK);
+    CHECK(recs.size() == 2 && recs[1].ack.status == JL_E_PROTO && recs[1].ack.seq == 2 && !recs[1].req);
+
+    /* len 超出包的剩余长度 */
+    RecSpec over;
+    over.len_delta = 1000;
+    std::string pkt = encode(over);
+    recs = decode(pkt);
+    CHECK(recs.size() == 1 && recs[0].ack.status == JL_E_PROTO);
+
+    /* magic 错误 */
+    pkt = encode(RecSpec{});
+    pkt[0] ^= 0x1;
+    recs = decode(pkt);
+    CHECK(recs.size() == 1 && recs[0].ack.status == JL_E_PROTO);
+}
+
+void testLensNotTerminated() {
+    RecSpec bad, next;
+    bad.seq = 1;
+    bad.lens = "proc_collector";   // 缺少结尾的 '\0'
+    next.seq = 2;
+    auto recs = decode(encode(bad) + encode(next));
+    /* 长度本身是对的，只有这一条非法，后面的记录照常解码 */
+    CHECK(recs.size() == 2);
+    CHECK(recs.size() == 2 && recs[0].ack.status == JL_E_INVAL && !recs[0].req);
+    CHECK(recs.size() == 2 && recs[1].ack.status == JL_OK && recs[1].req);
+}
+
+void testBadRecordMidPacket() {
+    RecSpec a, badPid, noLens, nanFreq, unknownOp, b;
+    a.seq = 1;
+    badPid.seq = 2;
+    badPid.pids = {100, -5};
+    noLens.seq = 3;
+    noLens.flags = JL_F_PIDS;   // ADD 缺少 JL_F_LENS
+    nanFreq.seq = 4;
+    nanFreq.flags |= JL_F_FREQ;
+    nanFreq.freq = std::nan("");
+    unknownOp.seq = 5;
+    unknownOp.op = 99;
+    b.seq = 6;
+    b.job_id = 2;
+
+    auto recs = decode(encode(a) + encode(badPid) + encode(noLens) + encode(nanFreq) + encode(unknownOp) + encode(b));
+    CHECK(recs.size() == 6);
+    if (recs.size() != 6) return;
+    const std::int32_t want[] = {JL_OK, JL_E_INVAL, JL_E_INVAL, JL_E_INVAL, JL_E_INVAL, JL_OK};
+    for (std::size_t i = 0; i < 6; ++i) {
+        CHECK(recs[i].ack.status == want[i]);
+        CHECK(recs[i].ack.seq == i + 1);
+        CHECK(recs[i].req.has_value() == (want[i] == JL_OK));
+    }
+    CHECK(recs[5].req && recs[5].req->job.JobID == 2);
+}
+
+void testEncodeAcks() {
+    std::vector<jl_ack> acks{{1, 10, JL_OK, 0}, {2, 11, JL_E_NOENT, 0}};
+    std::string reply = job_ctl::encodeAcks(acks);
+    CHECK(reply.size() == sizeof(jl_ack_hdr) + 2 * sizeof(jl_ack));
+    jl_ack_hdr h{};
+    std::memcpy(&h, reply.data(), sizeof(h));
+    CHECK(h.magic == JL_MAGIC && h.version == JL_VERSION && h.count == 2);
+    jl_ack second{};
+    std::memcpy(&second, reply.data() + sizeof(h) + sizeof(jl_ack), sizeof(second));
+    CHECK(second.seq == 2 && second.job_id == 11 && second.status == JL_E_NOENT);
+
+    reply = job_ctl::encodeAcks({});
+    CHECK(reply.size() == sizeof(jl_ack_hdr));
+}
+
+} // namespace
+
+void testFreqBounds() {
+    /* 0 表示由采集器决定；非 0 时不得低于 kMinSampleFreq */
+    RecSpec zero, slowest, tooSlow, updateTooSlow;
+    zero.seq = 1;
+    zero.flags |= JL_F_FREQ;
+    slowest.seq = 2;
+    slowest.flags |= JL_F_FREQ;
+    slowest.freq = kMinSampleFreq;
+    tooSlow.seq = 3;
+    tooSlow.flags |= JL_F_FREQ;
+    tooSlow.freq = 1e-300;
+    updateTooSlow.op = JL_OP_UPDATE;
+    updateTooSlow.seq = 4;
+    updateTooSlow.flags = JL_F_FREQ;
+    updateTooSlow.pids.clear();
+    updateTooSlow.lens.clear();
+    updateTooSlow.freq = 0.01;
+
+    auto recs = decode(encode(zero) + encode(slowest) + encode(tooSlow) + encode(updateTooSlow));
+    CHECK(recs.size() == 4);
+    if (recs.size() != 4) return;
+    const std::int32_t want[] = {JL_OK, JL_OK, JL_E_INVAL, JL_E_INVAL};
+    for (std::size_t i = 0; i < 4; ++i) CHECK(recs[i].ack.status == want[i]);
+}
+
+void testReservedJobID() {
+    /* JobID 0 保留给守护进程级记录，任何操作都不接受非正的 JobID */
+    RecSpec addZero, addNeg, rmZero, updZero, ok;
+    addZero.seq = 1;
+    addZero.job_id = 0;
+    addNeg.seq = 2;
+    addNeg.job_id = -3;
+    rmZero.op = JL_OP_REMOVE;
+    rmZero.seq = 3;
+    rmZero.job_id = 0;
+    rmZero.flags = 0;
+    rmZero.pids.clear();
+    rmZero.lens.clear();
+    updZero.op = JL_OP_ATTACH;
+    updZero.seq = 4;
+    updZero.job_id = 0;
+    updZero.flags = JL_F_PIDS;
+    updZero.lens.clear();
+    ok.seq = 5;
+
+    auto recs = decode(encode(addZero) + encode(addNeg) + encode(rmZero) + encode(updZero) + encode(ok));
+    CHECK(recs.size() == 5);
+    if (recs.size() != 5) return;
+    const std::int32_t want[] = {JL_E_INVAL, JL_E_INVAL, JL_E_INVAL, JL_E_INVAL, JL_OK};
+    for (std::size_t i = 0; i < 5; ++i) CHECK(recs[i].ack.status == want[i]);
+}
+
+int main() {
+    testValidRecords();
+    testTruncatedHeader();
+    testLengthMismatch();
+    testLensNotTerminated();
+    testBadRecordMidPacket();
+    testFreqBounds();
+    testReservedJobID();
+    testEncodeAcks();
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("job_ctl_codec_test: all checks passed\n");
+    return 0;
+}
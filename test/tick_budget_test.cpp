@@ -0,0 +1,84 @@
+// 批量采集周期预算的单元测试：模拟一个每块都很慢的批量采集器，
+// 检查超过截止时间后不再开始新的块、第一块总会执行、不限预算时全部处理
+#include "collector/tick_budget.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                          \
+        }                                                                        \
+    } while (0)
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kJobs  = 10;
+constexpr std::size_t kChunk = 2;
+
+/* 每块耗时 50ms 的批量采集器，记录处理过的作业 */
+struct SlowBatch {
+    std::vector<int> seen = std::vector<int>(kJobs, 0);
+    std::size_t calls = 0;
+    void operator()(std::size_t begin, std::size_t end) {
+        ++calls;
+        for (std::size_t i = begin; i < end; ++i) ++seen[i];
+        std::this_thread::sleep_for(50ms);
+    }
+};
+
+void testSlowBatchExceedsBudget() {
+    /* 预算 75ms：第二块在 50ms 时开始，结束于 100ms，之后的块都留到下个周期 */
+    SlowBatch batch;
+    std::size_t done = tick_budget::runChunks(kJobs, kChunk, true, Clock::now() + 75ms, batch);
+    CHECK(done >= kChunk);
+    CHECK(done < kJobs);
+    CHECK(done % kChunk == 0);
+    CHECK(batch.calls == done / kChunk);
+    for (std::size_t i = 0; i < kJobs; ++i) CHECK(batch.seen[i] == (i < done ? 1 : 0));
+}
+
+void testFirstChunkAlwaysRuns() {
+    SlowBatch batch;
+    std::size_t done = tick_budget::runChunks(kJobs, kChunk, true, Clock::now() - 1s, batch);
+    CHECK(done == kChunk);
+    CHECK(batch.calls == 1);
+}
+
+void testUnbounded() {
+    SlowBatch batch;
+    std::size_t done = tick_budget::runChunks(kJobs, 4, false, Clock::now() - 1s, batch);
+    CHECK(done == kJobs);
+    CHECK(batch.calls == 3);   // 4 + 4 + 2
+    for (int n : batch.seen) CHECK(n == 1);
+}
+
+void testEmpty() {
+    SlowBatch batch;
+    CHECK(tick_budget::runChunks(0, kChunk, true, Clock::now(), batch) == 0);
+    CHECK(batch.calls == 0);
+}
+
+} // namespace
+
+int main() {
+    testSlowBatchExceedsBudget();
+    testFirstChunkAlwaysRuns();
+    testUnbounded();
+    testEmpty();
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("tick_budget_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,225 @@
+// 分层时间轮的单元测试：各层级的挂载与逐级下落、取消、重复任务与 id 代号，
+// 通过 TimerWheelProbe 按 tick 手动推进，最后一项经由真实计时线程验证不会提前触发
+#include "timer_wheel_probe.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                          \
+        }                                                                        \
+    } while (0)
+
+constexpr uint64_t kNever = ~uint64_t(0);
+
+WorkStealingExecutor& executor() {
+    static WorkStealingExecutor ex(1);
+    return ex;
+}
+
+/* 从 start 起挂一个 delay 后到期的任务，逐 tick 推进，返回实际触发的 tick（未触发为 kNever） */
+uint64_t fireTick(uint64_t start, uint64_t delay) {
+    TimerScheduler sched(executor());
+    TimerWheelProbe p(sched, start);
+    uint64_t fired = kNever;
+    int count = 0;
+    p.arm(delay, [&] { fired = p.now(); ++count; });
+    p.stepTo(start + delay + 300);
+    CHECK(count <= 1);
+    CHECK(p.active() == 0);
+    return fired;
+}
+
+void testLevels() {
+    CHECK(fireTick(0, 1) == 1);
+    CHECK(fireTick(0, 5) == 5);
+    CHECK(fireTick(0, 255) == 255);
+    /* 第 1 级：跨过 256 的回绕后从第 1 级落回第 0 级 */
+    CHECK(fireTick(250, 10) == 260);
+    CHECK(fireTick(0, 256) == 256);
+    CHECK(fireTick(0, 300) == 300);
+    /* 第 2、3 级与溢出链表：从回绕点前几 tick 开始，避免逐 tick 推进上亿次 */
+    const uint64_t l2 = uint64_t(1) << 16, l3 = uint64_t(1) << 24, ov = uint64_t(1) << 32;
+    CHECK(fireTick(l2 - 5, 100) == l2 + 95);
+    CHECK(fireTick(0, 70000) == 70000);
+    CHECK(fireTick(l3 - 5, 100) == l3 + 95);
+    CHECK(fireTick(l3 - 5, 70000) == l3 + 69995);
+    CHECK(fireTick(ov - 5, 100) == ov + 95);
+    CHECK(fireTick(ov - 5, 70000) == ov + 69995);
+}
+
+void testFarTimerNotEarly() {
+    /* 第 3 级的任务经三次下落，到期前一 tick 仍未触发 */
+    TimerScheduler sched(executor());
+    TimerWheelProbe p(sched, 0);
+    const uint64_t d = 20000000;
+    int count = 0;
+    p.arm(d, [&] { ++count; });
+    p.advanceTo(d - 1);
+    CHECK(count == 0);
+    p.advanceTo(d);
+    CHECK(count == 1);
+}
+
+void testRandomDelays() {
+    /* 大量任务共享槽位，跨越第 3 级回绕；每个任务恰好在自己的到期 tick 触发 */
+    TimerScheduler sched(executor());
+    const uint64_t start = (uint64_t(1) << 24) - 1000;
+    TimerWheelProbe p(sched, start);
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uint64_t> delay(1, 300000);
+    const size_t n = 5000;
+    std::vector<uint64_t> expire(n), fired(n, kNever);
+    for (size_t i = 0; i < n; ++i) {
+        expire[i] = start + delay(rng);
+        p.arm(expire[i] - start, [&, i] { fired[i] = p.now(); });
+    }
+    CHECK(p.stepTo(start + 300000) == n);
+    size_t wrong = 0;
+    for (size_t i = 0; i < n; ++i) wrong += fired[i] != expire[i];
+    CHECK(wrong == 0);
+    CHECK(p.active() == 0);
+}
+
+void testCancel() {
+    TimerScheduler sched(executor());
+    TimerWheelProbe p(sched, 0);
+    int count = 0;
+    auto inc = [&] { ++count; };
+
+    /* 在第 1 级时取消 */
+    size_t a = p.arm(300, inc);
+    p.advanceTo(100);
+    CHECK(sched.cancelTimer(a));
+    CHECK(!sched.cancelTimer(a));
+
+    /* 在 256 处下落到第 0 级之后取消 */
+    size_t b = p.arm(200, inc);   // 到期 300
+    p.advanceTo(260);
+    CHECK(p.live(b));
+    CHECK(sched.cancelTimer(b));
+    p.advanceTo(1000);
+    CHECK(count == 0);
+    CHECK(p.active() == 0);
+
+    /* 同一槽链表的头、中、尾分别取消，其余照常触发 */
+    size_t ids[5];
+    for (auto& id : ids) id = p.arm(50, inc);
+    CHECK(sched.cancelTimer(ids[4]));   // 链表头（最后挂入）
+    CHECK(sched.cancelTimer(ids[2]));
+    CHECK(sched.cancelTimer(ids[0]));   // 链表尾
+    CHECK(p.advanceTo(1050) == 2);
+    CHECK(count == 2);
+
+    /* 溢出链表上的取消 */
+    TimerScheduler far(executor());
+    TimerWheelProbe q(far, (uint64_t(1) << 32) - 5);
+    int farCount = 0;
+    size_t x = q.arm(100, [&] { ++farCount; });
+    q.arm(100, [&] { ++farCount; });
+    CHECK(far.cancelTimer(x));
+    q.advanceTo(q.now() + 200);
+    CHECK(farCount == 1);
+    CHECK(q.active() == 0);
+}
+
+void testRepeating() {
+    TimerScheduler sched(executor());
+    TimerWheelProbe p(sched, 0);
+    std::vector<uint64_t> ticks;
+    size_t id = p.arm(100, [&] { ticks.push_back(p.now()); }, true);
+    p.stepTo(1000);
+    CHECK(ticks.size() == 10);
+    for (size_t i = 0; i < ticks.size(); ++i) CHECK(ticks[i] == (i + 1) * 100);
+    CHECK(p.live(id));
+    CHECK(sched.cancelTimer(id));
+    p.stepTo(2000);
+    CHECK(ticks.size() == 10);
+    CHECK(p.active() == 0);
+}
+
+void testIdGeneration() {
+    TimerScheduler sched(executor());
+    TimerWheelProbe p(sched, 0);
+    int oldCount = 0, newCount = 0;
+
+    size_t a = p.arm(10, [&] { ++oldCount; });
+    CHECK(a != 0);
+    CHECK(sched.cancelTimer(a));
+    /* 节点被复用：池下标相同，代号不同，旧 id 不能取消新任务 */
+    size_t b = p.arm(10, [&] { ++newCount; });
+    CHECK((a & 0xffffffffu) == (b & 0xffffffffu));
+    CHECK(a != b);
+    CHECK(!p.live(a));
+    CHECK(p.live(b));
+    CHECK(!sched.cancelTimer(a));
+    p.advanceTo(20);
+    CHECK(oldCount == 0 && newCount == 1);
+
+    /* 单次任务触发后节点回收，id 失效 */
+    CHECK(!p.live(b));
+    CHECK(!sched.cancelTimer(b));
+    CHECK(!sched.cancelTimer(0));
+    CHECK(!sched.cancelTimer(size_t(12345) << 32 | 999));   // 越界下标
+}
+
+void testNextWake() {
+    TimerScheduler sched(executor());
+    TimerWheelProbe p(sched, 10);
+    CHECK(p.nextWake() == 256);   // 第 0 级为空时醒在下一次回绕
+    p.arm(7, [] {});
+    CHECK(p.nextWake() == 17);
+    p.arm(1000, [] {});
+    CHECK(p.nextWake() == 17);
+    p.advanceTo(17);
+    CHECK(p.nextWake() == 256);
+}
+
+void testRealClock() {
+    /* 经由计时线程：不早于请求的延迟触发，取消的任务不触发 */
+    TimerScheduler sched(executor());
+    std::atomic<int> fired{0}, cancelled{0};
+    std::atomic<int64_t> elapsedMs{-1};
+    auto start = TimerScheduler::Clock::now();
+    sched.registerTimer(TimerScheduler::Duration(50), [&] {
+        elapsedMs = std::chrono::duration_cast<TimerScheduler::Duration>(TimerScheduler::Clock::now() - start).count();
+        ++fired;
+    });
+    size_t id = sched.registerTimer(TimerScheduler::Duration(30), [&] { ++cancelled; });
+    CHECK(sched.cancelTimer(id));
+    for (int i = 0; i < 200 && fired == 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    sched.shutdown();
+    CHECK(fired == 1);
+    CHECK(elapsedMs >= 50);
+    CHECK(cancelled == 0);
+}
+
+} // namespace
+
+int main() {
+    testLevels();
+    testFarTimerNotEarly();
+    testRandomDelays();
+    testCancel();
+    testRepeating();
+    testIdGeneration();
+    testNextWake();
+    testRealClock();
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("timer_scheduler_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,49 @@
+// 单元测试与基准共用：停掉 TimerScheduler 的计时线程，按 tick 手动推进时间轮，
+// 到期任务在调用线程上同步执行，不经过执行器，结果与真实时间无关
+#pragma once
+#include "common/timer_scheduler.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+struct TimerWheelProbe {
+    TimerScheduler& s;
+
+    TimerWheelProbe(TimerScheduler& sched, uint64_t startTick) : s(sched) {
+        s.shutdown();
+        s.currentTick = startTick;
+    }
+
+    // 与 addTask() 相同的挂载路径，但到期 tick 精确为 now() + delay
+    size_t arm(uint64_t delay, TimerScheduler::Task task, bool repeat = false) {
+        TimerScheduler::TimerNode* node = s.allocNode();
+        node->interval = TimerScheduler::Duration(delay);
+        node->repeat   = repeat;
+        node->task     = std::make_shared<const TimerScheduler::Task>(std::move(task));
+        node->expire   = s.currentTick + delay;
+        s.link(node);
+        return node->id;
+    }
+
+    // 推进到 target 并执行收集到的任务，返回执行的个数
+    size_t advanceTo(uint64_t target) {
+        s.advance(target);
+        size_t n = s.due.size();
+        for (auto& task : s.due) (*task)();
+        s.due.clear();
+        return n;
+    }
+
+    // 逐 tick 推进，任务执行时 now() 即其触发 tick
+    size_t stepTo(uint64_t target) {
+        size_t n = 0;
+        while (s.currentTick < target) n += advanceTo(s.currentTick + 1);
+        return n;
+    }
+
+    uint64_t now() const { return s.currentTick; }
+    size_t   active() const { return s.activeCount; }
+    bool     live(size_t id) const { return s.findNode(id) != nullptr; }
+    uint64_t nextWake() const { return s.nextWakeTick(); }
+};